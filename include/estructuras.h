@@ -23,13 +23,17 @@ typedef struct {
     char nombre_agente[MAX_NOMBRE];
     char nombre_familia[MAX_NOMBRE];
     char pipe_respuesta[MAX_PIPE_NAME];
+    int dia_solicitado;
     int hora_solicitada;
     int num_personas;
 } MensajeReserva;
 
-// Mensaje de bienvenida del controlador al agente.
+// Mensaje de bienvenida del controlador al agente. 'vista_ocupacion' es el
+// nombre de la memoria compartida con la ocupación (vacío si no hay).
 typedef struct {
+    int dia_actual;
     int hora_actual;
+    char vista_ocupacion[MAX_PIPE_NAME];
 } MensajeWelcome;
 
 // Respuestas del controlador.
@@ -37,12 +41,14 @@ typedef enum {
     RESERVA_OK,
     RESERVA_OTRAS_HORAS,
     RESERVA_EXTEMPORANEA,
-    RESERVA_NEGADA
+    RESERVA_NEGADA,
+    RESERVA_OCUPADO
 } TipoRespuesta;
 
 // Estructura para respuestas del controlador.
 typedef struct {
     TipoRespuesta tipo;
+    int dia_asignado;
     int hora_asignada;
     char mensaje[100];
 } RespuestaControlador;
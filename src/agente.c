@@ -12,19 +12,31 @@
  *  - **WELCOME ← (pipe respuesta del agente)**: recibido al iniciar la simulación.
  *  - **RESERVA → (pipe principal)**: por cada línea válida del archivo.
  *  - **RESPUESTA ← (pipe respuesta del agente)**: por cada reserva enviada.
+ *    Si la respuesta es "ocupado", la misma reserva se reenvía tras una espera
+ *    creciente, hasta MAX_REINTENTOS veces.
+ *
+ *  Si el WELCOME trae el nombre de la vista de ocupación, antes de cada envío
+ *  el agente prevé la decisión sobre una copia de esa vista y omite las
+ *  solicitudes que serían negadas (grupo mayor al aforo, sin cupo en todo el
+ *  horizonte, etc.), ahorrándole el trabajo al controlador.
  *  
  *      Parámetros esperados:
  *   -s <nombreAgente> Nombre único del agente.
  *   -a <archivoSolicitudes> Archivo con solicitudes (ej. "Familia,Hora,Personas").
+ *                           Un cuarto campo opcional indica el día de la reserva
+ *                           (por defecto, el día actual de la simulación, según
+ *                           la vista de ocupación o, sin ella, el del WELCOME).
  *   -p <pipePrincipal> FIFO por el cual el controlador recibe mensajes.
  *  
  *  Ejemplo de formato de solicitudes:
  *     Zuluaga,8,10
  *     Dominguez,8,4
  *     Rojas,10,10
+ *     Perez,9,6,2
  *  
- *  Este módulo no administra ocupación ni aforo; su rol es exclusivamente
- *  comunicarse con el controlador, reenviar solicitudes y esperar respuestas.
+ *  Este módulo no administra ocupación ni aforo; solo la consulta para filtrar,
+ *  y su rol es comunicarse con el controlador, reenviar solicitudes y esperar
+ *  respuestas.
  */
 
 #include <stdio.h>
@@ -34,8 +46,13 @@
 #include <getopt.h>
 #include <sys/types.h>
 #include "comunes.h"
+#include "reservas.h"
+#include "vista.h"
 #include "../include/estructuras.h"
 
+// Reintentos cuando el controlador responde "ocupado".
+#define MAX_REINTENTOS 3
+
 // Función principal del agente de reservas.
 int main(int argc, char *argv[]) {
     // Mensaje de bienvenida.
@@ -105,26 +122,43 @@ int main(int argc, char *argv[]) {
     printf("[AGENTE:%s] HELLO enviado. Esperando WELCOME...\n", nombre_agente);
 
     // Esperar mensaje WELCOME del controlador.
-    int fd_resp = abrir_pipe_lectura(pipe_respuesta);
-    if (fd_resp == -1) {
+    MensajeWelcome welcome;
+    ssize_t leidos = leer_de_pipe(pipe_respuesta, &welcome, sizeof(welcome));
+
+    if (leidos == -1) {
         fprintf(stderr, "[AGENTE] No se pudo abrir pipe de respuesta %s\n", pipe_respuesta);
         unlink(pipe_respuesta);
         return EXIT_FAILURE;
     }
 
-    MensajeWelcome welcome;
-    ssize_t leidos = read(fd_resp, &welcome, sizeof(welcome));
-    close(fd_resp);
-
     if (leidos != sizeof(welcome)) {
         fprintf(stderr, "[AGENTE] Error leyendo WELCOME\n");
         unlink(pipe_respuesta);
         return EXIT_FAILURE;
     }
 
-    // Mostrar hora actual recibida.
+    // Mostrar día y hora actuales recibidos.
+    int diaActual = welcome.dia_actual;
     int horaActual = welcome.hora_actual;
-    printf("[AGENTE:%s] WELCOME recibido. Hora actual = %d\n", nombre_agente, horaActual);
+    printf("[AGENTE:%s] WELCOME recibido. Día actual = %d, hora actual = %d\n", nombre_agente, diaActual, horaActual);
+
+    // Mapear la vista de ocupación y preparar una copia local para prever decisiones.
+    const VistaOcupacion *vista = NULL;
+    EstadoReservas local;
+    int omitidas = 0;
+
+    welcome.vista_ocupacion[sizeof(welcome.vista_ocupacion) - 1] = '\0';
+    if (welcome.vista_ocupacion[0] != '\0') {
+        vista = vista_abrir(welcome.vista_ocupacion);
+        if (vista && reservas_iniciar(&local, vista->horaIniSim, vista->horaFinSim,
+                                      vista->aforoMax, vista->horizonte) == -1) {
+            vista_cerrar(vista);
+            vista = NULL;
+        }
+    }
+    if (!vista) {
+        printf("[AGENTE:%s] Sin vista de ocupación; se enviarán todas las solicitudes.\n", nombre_agente);
+    }
 
     // Abrir archivo de solicitudes.
     FILE *file = fopen(archivo_solicitudes, "r");
@@ -146,17 +180,29 @@ int main(int argc, char *argv[]) {
         }
 
         char nombre_familia[MAX_NOMBRE];
-        int hora, personas;
+        int hora, personas, dia;
 
-        // Formato esperado: NombreFamilia, Hora, Personas.
-        if (sscanf(linea, " %63[^,] , %d , %d", nombre_familia, &hora, &personas) != 3) {
+        // Formato esperado: NombreFamilia, Hora, Personas[, Dia].
+        int campos = sscanf(linea, " %49[^,] , %d , %d , %d", nombre_familia, &hora, &personas, &dia);
+        if (campos != 3 && campos != 4) {
             fprintf(stderr, "[AGENTE] Línea %d inválida en %s: %s", linea_num, archivo_solicitudes, linea);
             continue;
         }
 
-        // Validación de la hora.
-        if (hora < horaActual) {
-            printf("[AGENTE:%s] Solicitud ignorada (extemporánea): familia=%s, hora=%d\n", nombre_agente, nombre_familia, hora);
+        // Esperar 2 segundos antes de enviar la siguiente, según enunciado.
+        sleep(2);
+
+        // Tomar el día y la hora actuales (y la ocupación) de la vista, si la hay.
+        if (vista) {
+            vista_leer(vista, &local, &diaActual, &horaActual);
+        }
+        if (campos == 3) {
+            dia = diaActual;
+        }
+
+        // Validación del día y la hora.
+        if (dia < diaActual || (dia == diaActual && hora < horaActual)) {
+            printf("[AGENTE:%s] Solicitud ignorada (extemporánea): familia=%s, día=%d, hora=%d\n", nombre_agente, nombre_familia, dia, hora);
             continue;
         }
 
@@ -169,59 +215,82 @@ int main(int argc, char *argv[]) {
         strncpy(msg.nombre_familia, nombre_familia, MAX_NOMBRE - 1);
         strncpy(msg.pipe_respuesta, pipe_respuesta, MAX_PIPE_NAME - 1);
 
+        msg.dia_solicitado = dia;
         msg.hora_solicitada = hora;
         msg.num_personas = personas;
 
-            // Esperar 2 segundos antes de enviar la siguiente, según enunciado.
-            sleep(2);
-        // Enviar mensaje de reserva al controlador.
-        if (write(fd_envio, &msg, sizeof(msg)) != sizeof(msg)) {
-            perror("[AGENTE] Error enviando mensaje");
-            fclose(file);
-            unlink(pipe_respuesta);
-            return EXIT_FAILURE;
-        }
-
-        printf("[AGENTE:%s] Solicitud enviada -> familia=%s, hora=%d, personas=%d\n",
-                nombre_agente, nombre_familia, hora, personas);
-
-        // Esperar respuesta del controlador.
-        fd_resp = abrir_pipe_lectura(pipe_respuesta);
-        if (fd_resp == -1) {
-            fprintf(stderr, "[AGENTE] Error abriendo pipe respuesta %s\n", pipe_respuesta);
-            fclose(file);
-            unlink(pipe_respuesta);
-            return EXIT_FAILURE;
+        // Omitir la solicitud si, según la ocupación publicada, sería negada.
+        if (vista) {
+            int nd, nh;
+            const char *razon;
+            if (reservas_prever(&local, &msg, diaActual, horaActual, &nd, &nh, &razon) == RESERVA_NEGADA) {
+                printf("[AGENTE:%s] Solicitud omitida: familia=%s, día=%d, hora=%d (%s)\n",
+                        nombre_agente, nombre_familia, dia, hora, razon);
+                omitidas++;
+                continue;
+            }
         }
 
+        // Enviar y esperar respuesta; si el controlador está ocupado, reintentar.
         RespuestaControlador respuesta;
-        leidos = read(fd_resp, &respuesta, sizeof(respuesta));
-        close(fd_resp);
-
-        if (leidos != sizeof(respuesta)) {
-            fprintf(stderr, "[AGENTE] Tamaño de respuesta inválido (%zd bytes)\n", leidos);
-            fclose(file);
-            unlink(pipe_respuesta);
-            return EXIT_FAILURE;
+        for (int intento = 0; ; intento++) {
+            // Enviar mensaje de reserva al controlador.
+            if (write(fd_envio, &msg, sizeof(msg)) != sizeof(msg)) {
+                perror("[AGENTE] Error enviando mensaje");
+                fclose(file);
+                unlink(pipe_respuesta);
+                return EXIT_FAILURE;
+            }
+
+            printf("[AGENTE:%s] Solicitud enviada -> familia=%s, día=%d, hora=%d, personas=%d\n",
+                    nombre_agente, nombre_familia, dia, hora, personas);
+
+            // Esperar respuesta del controlador.
+            leidos = leer_de_pipe(pipe_respuesta, &respuesta, sizeof(respuesta));
+            if (leidos == -1) {
+                fprintf(stderr, "[AGENTE] Error abriendo pipe respuesta %s\n", pipe_respuesta);
+                fclose(file);
+                unlink(pipe_respuesta);
+                return EXIT_FAILURE;
+            }
+
+            if (leidos != sizeof(respuesta)) {
+                fprintf(stderr, "[AGENTE] Tamaño de respuesta inválido (%zd bytes)\n", leidos);
+                fclose(file);
+                unlink(pipe_respuesta);
+                return EXIT_FAILURE;
+            }
+
+            if (respuesta.tipo != RESERVA_OCUPADO || intento == MAX_REINTENTOS) {
+                break;
+            }
+
+            // Esperar cada vez más antes de reintentar (1, 2, 4... segundos).
+            printf("[AGENTE:%s] ⏳ %s (reintento %d de %d)\n",
+                    nombre_agente, respuesta.mensaje, intento + 1, MAX_REINTENTOS);
+            sleep(1u << intento);
         }
 
         // Mostrar respuesta según el tipo.
         switch (respuesta.tipo) {
         case RESERVA_OK:
-            printf("[AGENTE:%s] ✅ %s (hora=%d)\n",
-                    nombre_agente, respuesta.mensaje, respuesta.hora_asignada);
+            printf("[AGENTE:%s] ✅ %s (día=%d, hora=%d)\n",
+                    nombre_agente, respuesta.mensaje, respuesta.dia_asignado, respuesta.hora_asignada);
             break;
         case RESERVA_OTRAS_HORAS:
-            printf("[AGENTE:%s] 🔁 %s (nueva hora=%d)\n",
-                    nombre_agente, respuesta.mensaje, respuesta.hora_asignada);
+            printf("[AGENTE:%s] 🔁 %s (nuevo día=%d, nueva hora=%d)\n",
+                    nombre_agente, respuesta.mensaje, respuesta.dia_asignado, respuesta.hora_asignada);
             break;
         case RESERVA_EXTEMPORANEA:
-            printf("[AGENTE:%s] ⏰ %s (nueva hora=%d)\n",
-                    nombre_agente, respuesta.mensaje, respuesta.hora_asignada);
+            printf("[AGENTE:%s] ⏰ %s (nuevo día=%d, nueva hora=%d)\n",
+                    nombre_agente, respuesta.mensaje, respuesta.dia_asignado, respuesta.hora_asignada);
             break;
         case RESERVA_NEGADA:
             printf("[AGENTE:%s] ❌ %s\n", nombre_agente, respuesta.mensaje);
             break;
+        case RESERVA_OCUPADO:
+            printf("[AGENTE:%s] ⏳ %s (sin más reintentos)\n", nombre_agente, respuesta.mensaje);
+            break;
         default:
             printf("[AGENTE:%s] Respuesta desconocida: %s (tipo=%d, hora=%d)\n",
                     nombre_agente, respuesta.mensaje, respuesta.tipo, respuesta.hora_asignada);
@@ -229,16 +298,19 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // Cerrar archivo de solicitudes.
+    // Cerrar archivo de solicitudes y la vista de ocupación.
     fclose(file);
+    if (vista) {
+        printf("[AGENTE:%s] Solicitudes omitidas por la vista de ocupación: %d\n", nombre_agente, omitidas);
+        vista_cerrar(vista);
+        reservas_liberar(&local);
+    }
     printf("[AGENTE:%s] Todas las solicitudes procesadas. Esperando FIN del controlador...\n", nombre_agente);
 
     // Esperar FIN del controlador (bloqueante). Abrimos el pipe de respuesta para lectura.
-    int fd_fin = abrir_pipe_lectura(pipe_respuesta);
-    if (fd_fin != -1) {
-        char finbuf[4] = {0};
-        ssize_t r = read(fd_fin, finbuf, 3);
-        close(fd_fin);
+    char finbuf[4] = {0};
+    ssize_t r = leer_de_pipe(pipe_respuesta, finbuf, 3);
+    if (r != -1) {
         if (r == 3 && strcmp(finbuf, "FIN") == 0) {
             printf("[AGENTE:%s] FIN recibido. Terminando.\n", nombre_agente);
         } else {
@@ -0,0 +1,223 @@
+/**
+ *  @file bench_core.c
+ *  @brief Microbenchmark de la lógica de decisión de reservas.
+ *
+ *  Mide el costo de las funciones del núcleo de admisión (reservas.c) sin
+ *  FIFOs, hilos ni reloj simulado: genera solicitudes sintéticas con una
+ *  semilla fija y las pasa por cada función con el calendario precargado a
+ *  distintos niveles de ocupación.
+ *
+ *  Las solicitudes son un conjunto pequeño de CONJUNTO entradas compactas (día,
+ *  hora, personas) que se recorre cíclicamente, para que quepa en caché y la
+ *  medición refleje el núcleo y no el tráfico a memoria.
+ *
+ *      Funciones medidas:
+ *  - **puede_reservar_en_hora:** consulta de un bloque de 2 horas.
+ *  - **buscar_bloque_dos_horas:** búsqueda del primer bloque libre, pasando a
+ *    los días siguientes del horizonte si hace falta.
+ *  - **reservas_decidir:** decisión completa (incluye los procesar_reserva_*
+ *    y el texto de la respuesta). El estado se restaura cada LOTE solicitudes
+ *    para que el nivel de ocupación se mantenga.
+ *
+ *  Reporta ns/op y ciclos/op. Los ciclos se leen del TSC en x86; en otras
+ *  arquitecturas solo se reportan ns/op.
+ *
+ *      Parámetros esperados:
+ *   -n <solicitudes> Solicitudes sintéticas por medición (por defecto 2000000).
+ *   -t <aforoMax> Aforo del parque (por defecto 50).
+ *   -d <diasHorizonte> Días del calendario (por defecto 7).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "reservas.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAY_TSC 1
+#else
+#define HAY_TSC 0
+#endif
+
+// Parámetros de la simulación sintética.
+#define HORA_INI 7
+#define HORA_FIN 19
+#define LOTE 256
+#define CONJUNTO 4096   // Potencia de 2.
+
+// Evita que el compilador descarte los resultados.
+static volatile long sumidero;
+
+// Generador xorshift con semilla fija para que las corridas sean comparables.
+static unsigned int semilla = 2463534242u;
+static unsigned int aleatorio(void) {
+    semilla ^= semilla << 13;
+    semilla ^= semilla >> 17;
+    semilla ^= semilla << 5;
+    return semilla;
+}
+
+// Solicitud sintética compacta.
+typedef struct {
+    int dia;
+    int hora;
+    int personas;
+    int hora_actual;
+} Solicitud;
+
+static Solicitud solicitudes[CONJUNTO];
+
+// Marca de tiempo y de ciclos.
+typedef struct {
+    double ns;
+    unsigned long long ciclos;
+} Marca;
+
+static Marca marcar(void) {
+    Marca m;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    m.ns = ts.tv_sec * 1e9 + ts.tv_nsec;
+#if HAY_TSC
+    m.ciclos = __rdtsc();
+#else
+    m.ciclos = 0;
+#endif
+    return m;
+}
+
+// Imprimir una medición.
+static void reportar(const char *nombre, int llenado, long ops, Marca ini, Marca fin) {
+    double ns_op = (fin.ns - ini.ns) / ops;
+#if HAY_TSC
+    double ciclos_op = (double)(fin.ciclos - ini.ciclos) / ops;
+    printf("%-24s llenado=%3d%%  %8.2f ns/op  %8.1f ciclos/op\n", nombre, llenado, ns_op, ciclos_op);
+#else
+    printf("%-24s llenado=%3d%%  %8.2f ns/op  ciclos/op n/d\n", nombre, llenado, ns_op);
+#endif
+}
+
+// Precargar cada hora de cada día con una fracción del aforo, con algo de variación.
+static void precargar(EstadoReservas *e, int llenado) {
+    for (int d = e->dia_base; d < e->dia_base + e->horizonte; d++) {
+        unsigned short *s = reservas_dia(e, d);
+        for (int i = 0; i < e->horas_dia; i++) {
+            int base = e->aforoMax * llenado / 100;
+            int variacion = (int)(aleatorio() % 5) - 2;
+            int ocup = base + variacion;
+            if (ocup < 0) { ocup = 0; }
+            if (ocup > e->aforoMax) { ocup = e->aforoMax; }
+            s[i] = (unsigned short)ocup;
+        }
+    }
+}
+
+// Programa principal.
+int main(int argc, char *argv[]) {
+    long total = 2000000;
+    int aforo = 50;
+    int horizonte = 7;
+
+    // Procesar argumentos.
+    int opcion;
+    while ((opcion = getopt(argc, argv, "n:t:d:")) != -1) {
+        switch (opcion) {
+        case 'n':
+            total = atol(optarg);
+            break;
+        case 't':
+            aforo = atoi(optarg);
+            break;
+        case 'd':
+            horizonte = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Uso: %s [-n solicitudes] [-t aforoMax] [-d diasHorizonte]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (total <= 0 || aforo <= 0 || aforo > MAX_AFORO || horizonte <= 0) {
+        fprintf(stderr, "Parámetros inválidos.\nUso: %s [-n solicitudes] [-t aforoMax] [-d diasHorizonte]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Generar solicitudes sintéticas: días y horas en rango (y algunos fuera) y grupos pequeños.
+    for (int i = 0; i < CONJUNTO; i++) {
+        Solicitud *sol = &solicitudes[i];
+        sol->dia = (int)(aleatorio() % (horizonte + 1));
+        sol->hora = HORA_INI + (int)(aleatorio() % (HORA_FIN - HORA_INI + 3)) - 1;
+        sol->personas = 1 + (int)(aleatorio() % (aforo / 4 + 1));
+        sol->hora_actual = HORA_INI + (int)(aleatorio() % 4);
+    }
+
+    // Mensaje que reutiliza reservas_decidir; solo cambian día, hora y personas.
+    MensajeReserva msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.tipo = MSG_RESERVA;
+    snprintf(msg.nombre_familia, sizeof(msg.nombre_familia), "FamiliaBench");
+
+    printf("bench-core: %ld solicitudes por medición (%d distintas), aforo %d, horas %d-%d, horizonte %d días\n\n",
+            total, CONJUNTO, aforo, HORA_INI, HORA_FIN, horizonte);
+
+    const int niveles[] = {0, 50, 90, 100};
+    const int total_niveles = sizeof(niveles) / sizeof(niveles[0]);
+
+    EstadoReservas base, estado;
+    RespuestaControlador respuesta;
+    if (reservas_iniciar(&base, HORA_INI, HORA_FIN, aforo, horizonte) == -1 ||
+        reservas_iniciar(&estado, HORA_INI, HORA_FIN, aforo, horizonte) == -1) {
+        fprintf(stderr, "Sin memoria para un horizonte de %d días\n", horizonte);
+        return EXIT_FAILURE;
+    }
+
+    for (int n = 0; n < total_niveles; n++) {
+        int llenado = niveles[n];
+        precargar(&base, llenado);
+        long acumulado = 0;
+
+        // puede_reservar_en_hora.
+        Marca ini = marcar();
+        for (long i = 0; i < total; i++) {
+            const Solicitud *sol = &solicitudes[i & (CONJUNTO - 1)];
+            acumulado += puede_reservar_en_hora(&base, sol->dia, sol->hora, sol->personas);
+        }
+        Marca fin = marcar();
+        reportar("puede_reservar_en_hora", llenado, total, ini, fin);
+
+        // buscar_bloque_dos_horas.
+        ini = marcar();
+        for (long i = 0; i < total; i++) {
+            const Solicitud *sol = &solicitudes[i & (CONJUNTO - 1)];
+            int dia = sol->dia;
+            acumulado += buscar_bloque_dos_horas(&base, sol->personas, &dia, sol->hora_actual);
+            acumulado += dia;
+        }
+        fin = marcar();
+        reportar("buscar_bloque_dos_horas", llenado, total, ini, fin);
+
+        // reservas_decidir, restaurando el estado en cada lote.
+        ini = marcar();
+        for (long i = 0; i < total; i++) {
+            const Solicitud *sol = &solicitudes[i & (CONJUNTO - 1)];
+            if (i % LOTE == 0) { reservas_copiar(&estado, &base); }
+            msg.dia_solicitado = sol->dia;
+            msg.hora_solicitada = sol->hora;
+            msg.num_personas = sol->personas;
+            reservas_decidir(&estado, &msg, 0, sol->hora_actual, &respuesta);
+            acumulado += respuesta.hora_asignada;
+        }
+        fin = marcar();
+        reportar("reservas_decidir", llenado, total, ini, fin);
+
+        sumidero = acumulado;
+        printf("\n");
+    }
+
+    reservas_liberar(&base);
+    reservas_liberar(&estado);
+    return EXIT_SUCCESS;
+}
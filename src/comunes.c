@@ -31,3 +31,19 @@ int abrir_pipe_lectura(const char *nombre) {
     }
     return fd;
 }
+
+// Abrir un pipe, leer un mensaje y cerrarlo.
+// Si la lectura da EOF sin datos (el escritor anterior aún no había cerrado
+// cuando se reabrió el pipe), se vuelve a abrir y esperar al siguiente escritor.
+ssize_t leer_de_pipe(const char *nombre, void *buf, size_t tam) {
+    for (int intento = 0; intento < 3; intento++) {
+        int fd = abrir_pipe_lectura(nombre);
+        if (fd == -1) { return -1; }
+
+        ssize_t r = read(fd, buf, tam);
+        close(fd);
+
+        if (r != 0) { return r; }
+    }
+    return 0;
+}
@@ -12,5 +12,6 @@
 int crear_pipe(const char *nombre);
 int abrir_pipe_escritura(const char *nombre);
 int abrir_pipe_lectura(const char *nombre);
+ssize_t leer_de_pipe(const char *nombre, void *buf, size_t tam);
 
 #endif
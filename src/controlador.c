@@ -7,11 +7,28 @@
  *  gestiona  la  ocupación del parque,  simula el avance del tiempo y decide si
  *  una familia  puede  reservar en la hora  solicitada, debe reprogramarse o si
  *  la solicitud debe ser negada según las reglas del sistema.
+ *
+ *  Las reservas pueden hacerse para cualquier día dentro de un horizonte de
+ *  días a partir del día actual. Al terminar cada día, este sale del calendario
+ *  y se abre uno nuevo al final del horizonte.
  *  
  *      Concurrencia:
- *  El controlador usa dos hilos POSIX:
- *  - **Hilo de reloj:** avanza la hora simulada y muestra el estado.
- *  - **Hilo de recepción:** escucha continuamente peticiones de los agentes.
+ *  El controlador usa tres hilos POSIX:
+ *  - **Hilo de reloj:** avanza la hora (y el día) simulados y muestra el estado.
+ *  - **Hilo de recepción:** escucha continuamente peticiones de los agentes,
+ *    las separa en una cola por agente y las atiende por turnos (deficit
+ *    round-robin) para que ningún agente acapare el controlador.
+ *  - **Hilo emisor:** escribe las respuestas en los pipes de los agentes, de
+ *    modo que un agente lento no frena las decisiones de los demás.
+ *
+ *  Al recibir SIGUSR1, el controlador hace fork() y el hijo escribe un reporte
+ *  JSON (contadores, ocupación por día y hora y resultados por agente) desde su
+ *  copia del estado, mientras el padre sigue atendiendo reservas.
+ *
+ *  La ocupación se publica en una memoria compartida (ver vista.c) cuyo nombre
+ *  va en el WELCOME: completa en cada hora y, tras cada decisión, solo el día
+ *  que cambió. Los agentes la leen para no enviar solicitudes que con
+ *  seguridad serían negadas.
  *  
  *      Parámetros esperados:
  *   -i <horaInicio> Hora inicial de la simulación (7–19).
@@ -19,6 +36,18 @@
  *   -s <segundosHora> Cantidad de segundos que equivale a 1 hora simulada.
  *   -t <aforoMax> Límite de personas permitidas simultáneamente.
  *   -p <pipePrincipal> FIFO por el cual los agentes envían solicitudes.
+ *   -n <diasSimulacion> (Opcional) Días que dura la simulación (por defecto 1).
+ *   -d <diasHorizonte> (Opcional) Días hacia adelante que se pueden reservar,
+ *                      incluido el actual (por defecto 1).
+ *   -b <maxPendientes> (Opcional) Solicitudes encoladas permitidas; por encima
+ *                      se responde "ocupado" de inmediato (por defecto 64).
+ *   -q <quantum> (Opcional) Solicitudes por agente en cada turno (por defecto 1).
+ *   -w <timeoutMs> (Opcional) Tiempo máximo para entregar una respuesta a un
+ *                  agente que no abre su pipe (por defecto 5000).
+ *   -g <archivoTraza> (Opcional) Graba cada mensaje recibido en una traza
+ *                     binaria que luego puede reproducir `reproductor`.
+ *   -r <dirReportes> (Opcional) Directorio de las instantáneas pedidas con
+ *                    SIGUSR1 (por defecto /tmp).
  *  
  *  Este módulo actúa como el núcleo del sistema de reservas, gestionando
  *  simultáneamente tiempo, ocupación y comunicación con múltiples agentes.
@@ -33,11 +62,19 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <time.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include "comunes.h"
+#include "reservas.h"
+#include "planificador.h"
+#include "emisor.h"
+#include "traza.h"
+#include "vista.h"
+#include "instantanea.h"
 #include "../include/estructuras.h"
 
 // Constantes.
-#define MAX_HORAS 24
 #define MAX_AGENTES 200
 
 // Variables globales.
@@ -45,22 +82,47 @@ static int horaIniSim = 7;
 static int horaFinSim = 19;
 static int aforoMax = 50;
 static int segHorasSim = 1;
-static int ocupacion[MAX_HORAS + 2];
+static int diasSim = 1;
+static int diasHorizonte = 1;
+
+// Ocupación por día y hora y estadísticas finales.
+static EstadoReservas estado;
+static int solicitudes_ocupado = 0;
+
+// Resultados por agente, para las instantáneas.
+static EstadisticasAgente estadisticas[MAX_AGENTES];
+static int total_estadisticas = 0;
+
+// Colas por agente y límite de solicitudes pendientes.
+static Planificador planificador;
+static int maxPendientes = 64;
+static int quantum = 1;
+
+// Tiempo máximo para entregar una respuesta.
+static int timeoutRespuestaMs = 5000;
 
 // Pipes de los agentes.
 static char pipes_agentes[MAX_AGENTES][128];
 static int total_agentes = 0;
 
-// Estadísticas finales.
-static int solicitudes_ok = 0;
-static int solicitudes_extemporaneas = 0;
-static int solicitudes_reprogramadas = 0;
-static int solicitudes_negadas = 0;
-
 // Pipe principal.
 static const char *pipe_principal = NULL;
 
+// Traza de mensajes recibidos (opcional).
+static const char *archivo_traza = NULL;
+static Traza traza;
+
+// Ocupación publicada en memoria compartida para los agentes.
+static char nombre_vista[MAX_PIPE_NAME];
+static VistaOcupacion *vista = NULL;
+
+// Instantáneas pedidas con SIGUSR1.
+static const char *dir_reportes = "/tmp";
+static volatile sig_atomic_t instantanea_pedida = 0;
+static int total_instantaneas = 0;
+
 // Reloj global.
+static int dia_actual = 0;
 static int hora_actual = 0;
 
 // Flag de terminación
@@ -78,109 +140,105 @@ static void registrar_pipe_agente(const char *pipeN) {
             return;
         }
     }
-    strncpy(pipes_agentes[total_agentes], pipeN, 127);
-    total_agentes++;
-}
 
-// Verificar si se puede reservar en la hora dada.
-static int puede_reservar_en_hora(int h, int personas) {
-    if (h < horaIniSim) { return 0; }
-    if (h + 1 > horaFinSim) { return 0; }
+    // Si no hay lugar, reutilizar el de un agente que ya terminó (su pipe ya no existe).
+    int libre = total_agentes;
+    if (libre == MAX_AGENTES) {
+        for (libre = 0; libre < MAX_AGENTES; libre++) {
+            if (access(pipes_agentes[libre], F_OK) == -1) { break; }
+        }
+        if (libre == MAX_AGENTES) { return; }
+    } else {
+        total_agentes++;
+    }
 
-    return !(ocupacion[h] + personas > aforoMax || ocupacion[h+1] + personas > aforoMax);
+    memset(pipes_agentes[libre], 0, sizeof(pipes_agentes[libre]));
+    strncpy(pipes_agentes[libre], pipeN, sizeof(pipes_agentes[libre]) - 1);
 }
 
-// Buscar un bloque de 2 horas disponible desde 'inicio' en adelante.
-static int buscar_bloque_dos_horas(int personas, int inicio) {
-    if (inicio < horaIniSim) { inicio = horaIniSim; }
-
-    for (int h = inicio; h <= horaFinSim - 1; h++) {
-        if (puede_reservar_en_hora(h, personas)) {
-            return h;
+// Estadísticas de un agente, creándolas si es nuevo. NULL si no caben más.
+static EstadisticasAgente *estadisticas_agente(const char *nombre) {
+    for (int i = 0; i < total_estadisticas; i++) {
+        if (strcmp(estadisticas[i].nombre_agente, nombre) == 0) {
+            return &estadisticas[i];
         }
     }
-    return -1;
+    if (total_estadisticas == MAX_AGENTES) { return NULL; }
+
+    EstadisticasAgente *a = &estadisticas[total_estadisticas++];
+    memset(a, 0, sizeof(*a));
+    strncpy(a->nombre_agente, nombre, MAX_NOMBRE - 1);
+    return a;
 }
 
-// Enviar respuesta al agente.
+// Contar el resultado de una solicitud en las estadísticas de su agente.
+static void contar_resultado(const MensajeReserva *msg, TipoRespuesta tipo) {
+    EstadisticasAgente *a = estadisticas_agente(msg->nombre_agente);
+    if (!a) { return; }
+
+    switch (tipo) {
+    case RESERVA_OK:           a->ok++;            break;
+    case RESERVA_OTRAS_HORAS:  a->reprogramadas++; break;
+    case RESERVA_EXTEMPORANEA: a->extemporaneas++; break;
+    case RESERVA_NEGADA:       a->negadas++;       break;
+    case RESERVA_OCUPADO:      a->ocupado++;       break;
+    }
+}
+
+// Enviar respuesta al agente (la entrega el hilo emisor).
 static void enviar_respuesta(const MensajeReserva *msg, const RespuestaControlador *resp) {
     registrar_pipe_agente(msg->pipe_respuesta);
-
-    int fd = abrir_pipe_escritura(msg->pipe_respuesta);
-    if (fd == -1) { return; }
-
-    write(fd, resp, sizeof(*resp));
-    close(fd);
+    emisor_encolar(msg->pipe_respuesta, resp, sizeof(*resp));
 }
 
-// Procesar diferentes tipos de reservas.
-static void procesar_reserva_ok(const MensajeReserva *msg) {
-    ocupacion[msg->hora_solicitada] += msg->num_personas;
-    ocupacion[msg->hora_solicitada + 1] += msg->num_personas;
-    solicitudes_ok++;
-
-    RespuestaControlador respuesta;
-    respuesta.tipo = RESERVA_OK;
-    respuesta.hora_asignada = msg->hora_solicitada;
-    snprintf(respuesta.mensaje, 300, "Reserva OK para %s (%d personas) en %d-%d",
-                msg->nombre_familia,
-                msg->num_personas,
-                msg->hora_solicitada,
-                msg->hora_solicitada+2);
-    enviar_respuesta(msg, &respuesta);
-}
+// Imprimir estado actual de ocupación.
+static void imprimir_estado(int h) {
+    printf("\n======= DÍA %d HORA %d =======\n", dia_actual, h);
 
-// Procesar reserva reprogramada a otras horas.
-static void procesar_reserva_otras_horas(const MensajeReserva *msg, int nuevaH) {
-    ocupacion[nuevaH] += msg->num_personas;
-    ocupacion[nuevaH + 1] += msg->num_personas;
-    solicitudes_reprogramadas++;
+    if (h - 1 >= horaIniSim) {
+        printf("SALEN (%d-%d): %d personas\n", h-1, h, reservas_ocupacion(&estado, dia_actual, h-1));
+    }
 
-    RespuestaControlador respuesta;
-    respuesta.tipo = RESERVA_OTRAS_HORAS;
-    respuesta.hora_asignada = nuevaH;
-    snprintf(respuesta.mensaje, 300, "Sin cupo en %d. Reprogramada a %d-%d",
-                msg->hora_solicitada, nuevaH, nuevaH+2);
-    enviar_respuesta(msg, &respuesta);
+    if (h >= horaIniSim && h <= horaFinSim) {
+        printf("ESTÁN (%d-%d): %d personas\n", h, h+1, reservas_ocupacion(&estado, dia_actual, h));
+    }
 }
 
-// Procesar reserva extemporánea.
-static void procesar_reserva_extemporanea(const MensajeReserva *msg, int nuevaH) {
-    ocupacion[nuevaH] += msg->num_personas;
-    ocupacion[nuevaH + 1] += msg->num_personas;
-    solicitudes_extemporaneas++;
-
-    RespuestaControlador respuesta;
-    respuesta.tipo = RESERVA_EXTEMPORANEA;
-    respuesta.hora_asignada = nuevaH;
-    snprintf(respuesta.mensaje, 300, "Hora solicitada ya pasó. Reprogramada a %d-%d",
-                nuevaH, nuevaH+2);
-    enviar_respuesta(msg, &respuesta);
-}
+// Imprimir horas pico y valle de un día del calendario.
+static void imprimir_dia(int dia) {
+    int max = -1, min = 9999, total = 0;
+    for (int h = horaIniSim; h <= horaFinSim; h++) {
+        int ocup = reservas_ocupacion(&estado, dia, h);
+        if (ocup > max) max = ocup;
+        if (ocup < min) min = ocup;
+        total += ocup;
+    }
 
-// Procesar reserva negada.
-static void procesar_reserva_negada(const MensajeReserva *msg, const char *razon) {
-    solicitudes_negadas++;
+    printf("Día %d (%d persona-hora)\n", dia, total);
+    printf("  Horas pico (%d): ", max);
+    for (int h = horaIniSim; h <= horaFinSim; h++) {
+        if (reservas_ocupacion(&estado, dia, h) == max) printf("%d ", h);
+    }
 
-    RespuestaControlador respuesta;
-    respuesta.tipo = RESERVA_NEGADA;
-    respuesta.hora_asignada = -1;
-    snprintf(respuesta.mensaje, 300, "Reserva negada para %s: %s",
-                msg->nombre_familia, razon);
-    enviar_respuesta(msg, &respuesta);
+    printf("\n  Horas valle (%d): ", min);
+    for (int h = horaIniSim; h <= horaFinSim; h++) {
+        if (reservas_ocupacion(&estado, dia, h) == min) {
+            printf("%d ", h);
+        }
+    }
+    printf("\n");
 }
 
-// Imprimir estado actual de ocupación.
-static void imprimir_estado(int h) {
-    printf("\n======= HORA %d =======\n", h);
-
-    if (h - 1 >= horaIniSim) {
-        printf("SALEN (%d-%d): %d personas\n", h-1, h, ocupacion[h-1]);
+// Imprimir todos los días del horizonte.
+static void imprimir_calendario(void) {
+    for (int d = estado.dia_base; d < estado.dia_base + estado.horizonte; d++) {
+        imprimir_dia(d);
     }
+}
 
-    if (h >= horaIniSim && h <= horaFinSim) {
-        printf("ESTÁN (%d-%d): %d personas\n", h, h+1, ocupacion[h]);
-    }
+// ¿Terminó el último día de la simulación?
+static int simulacion_terminada(void) {
+    return dia_actual >= diasSim - 1 && hora_actual > horaFinSim;
 }
 
 // Hilo de reloj que avanza la hora simulada.
@@ -190,94 +248,123 @@ void *hiloReloj(void *arg) {
         sleep(segHorasSim);
 
         pthread_mutex_lock(&mutex);
-        if (hora_actual > horaFinSim) {
+        if (simulacion_terminada()) {
             pthread_mutex_unlock(&mutex);
             break;
         }
 
+        // Cambio de día: el día que terminó sale del calendario.
+        if (hora_actual > horaFinSim) {
+            printf("\n======= FIN DEL DÍA %d =======\n", dia_actual);
+            imprimir_calendario();
+
+            dia_actual++;
+            hora_actual = horaIniSim;
+            reservas_avanzar_dia(&estado);
+        }
+
         imprimir_estado(hora_actual);
         hora_actual++;
+        vista_publicar(vista, &estado, dia_actual, hora_actual);
         pthread_mutex_unlock(&mutex);
     }
     return NULL;
 }
 
-// Hilo de recepción de mensajes de reserva.
-void *hiloRecepcion(void *arg) {
-    (void)arg;
+// Atender el saludo HELLO de un agente.
+static void atender_hola(const MensajeHola *hola) {
+    pthread_mutex_lock(&mutex);
+    printf("[CONTROLADOR] HELLO recibido de %s\n", hola->nombre_agente);
+    registrar_pipe_agente(hola->pipe_respuesta);
+    estadisticas_agente(hola->nombre_agente);
+    traza_registrar_hola(&traza, hola, dia_actual, hora_actual);
+
+    MensajeWelcome w;
+    memset(&w, 0, sizeof(w));
+    w.dia_actual = dia_actual;
+    w.hora_actual = hora_actual;
+    if (vista) {
+        strncpy(w.vista_ocupacion, nombre_vista, sizeof(w.vista_ocupacion) - 1);
+    }
+    emisor_encolar(hola->pipe_respuesta, &w, sizeof(w));
 
-    // Habilitar cancelación asíncrona del hilo
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
+    pthread_mutex_unlock(&mutex);
+}
 
-    // Abrir el pipe principal UNA SOLA VEZ
-    int fd = abrir_pipe_lectura(pipe_principal);
-    if (fd == -1) {
-        fprintf(stderr, "[CONTROLADOR] Error abriendo pipe principal\n");
-        return NULL;
-    }
+// Atender una solicitud de reserva ya sacada de su cola.
+static void atender_reserva(const MensajeReserva *msg, uint64_t llegada_ns) {
+    pthread_mutex_lock(&mutex);
 
-    // Ahora cambiar a modo NO BLOQUEANTE para las lecturas
-    int flags = fcntl(fd, F_GETFL, 0);
-    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    printf("[CONTROLADOR] Petición: agente=%s familia=%s día=%d hora=%d personas=%d\n",
+            msg->nombre_agente,
+            msg->nombre_familia,
+            msg->dia_solicitado,
+            msg->hora_solicitada,
+            msg->num_personas);
+    registrar_pipe_agente(msg->pipe_respuesta);
 
-    while (!debe_terminar) {
-        // ¿Ya se acabó la simulación?
-        pthread_mutex_lock(&mutex);
-        int fin = (hora_actual > horaFinSim);
-        pthread_mutex_unlock(&mutex);
+    // Decidir la reserva, publicar la ocupación, grabarla en la traza y responder.
+    RespuestaControlador respuesta;
+    reservas_decidir(&estado, msg, dia_actual, hora_actual, &respuesta);
+    vista_publicar_dia(vista, &estado, respuesta.dia_asignado);
+    contar_resultado(msg, respuesta.tipo);
+    traza_registrar_reserva(&traza, msg, llegada_ns, dia_actual, hora_actual, &respuesta);
+    enviar_respuesta(msg, &respuesta);
 
-        if (fin) {
-            break;
-        }
+    pthread_mutex_unlock(&mutex);
+}
+
+// Rechazar de inmediato una solicitud porque hay demasiadas pendientes.
+static void rechazar_ocupado(const MensajeReserva *msg, uint64_t llegada_ns) {
+    pthread_mutex_lock(&mutex);
+    solicitudes_ocupado++;
+
+    printf("[CONTROLADOR] Ocupado: agente=%s familia=%s (%d pendientes)\n",
+            msg->nombre_agente, msg->nombre_familia, planificador.pendientes);
+
+    RespuestaControlador respuesta;
+    respuesta.tipo = RESERVA_OCUPADO;
+    respuesta.dia_asignado = -1;
+    respuesta.hora_asignada = -1;
+    snprintf(respuesta.mensaje, sizeof(respuesta.mensaje), "Controlador ocupado. Reintente la reserva de %s",
+                msg->nombre_familia);
+    contar_resultado(msg, respuesta.tipo);
+    traza_registrar_reserva(&traza, msg, llegada_ns, dia_actual, hora_actual, &respuesta);
+    enviar_respuesta(msg, &respuesta);
+
+    pthread_mutex_unlock(&mutex);
+}
 
+// Leer todo lo disponible en el pipe principal. Devuelve cuántos mensajes se leyeron.
+static int drenar_pipe_principal(int fd) {
+    int leidos = 0;
+
+    while (1) {
         // Leer el tipo de mensaje primero.
         TipoMensaje tipo;
         ssize_t r = read(fd, &tipo, sizeof(tipo));
 
-        if (r == -1 && errno == EAGAIN) {
-            // No había datos aún
-            struct timespec ts = {0, 50000000}; // 50ms
-            nanosleep(&ts, NULL);
-            continue;
-        }
-
         if (r != sizeof(tipo)) {
-            // Lectura incompleta o EOF
-            struct timespec ts = {0, 50000000}; // 50ms
-            nanosleep(&ts, NULL);
-            continue;
+            // No había datos aún, lectura incompleta o EOF.
+            return leidos;
         }
+        leidos++;
 
         // Procesar mensaje de saludo (HELLO).
         if (tipo == MSG_HOLA) {
             MensajeHola hola;
+            hola.tipo = tipo;
 
             // Ya leímos el campo "tipo", faltan los demás bytes.
             ssize_t r2 = read(fd, ((char*)&hola) + sizeof(tipo), sizeof(hola) - sizeof(tipo));
 
-            if (r2 != sizeof(hola) - sizeof(tipo)) {
-                continue;
+            if (r2 == sizeof(hola) - sizeof(tipo)) {
+                atender_hola(&hola);
             }
-
-            pthread_mutex_lock(&mutex);
-            printf("[CONTROLADOR] HELLO recibido de %s\n", hola.nombre_agente);
-            registrar_pipe_agente(hola.pipe_respuesta);
-
-            MensajeWelcome w;
-            w.hora_actual = hora_actual;
-
-            int fdw = abrir_pipe_escritura(hola.pipe_respuesta);
-            if (fdw != -1) {
-                write(fdw, &w, sizeof(w));
-                close(fdw);
-            }
-
-            pthread_mutex_unlock(&mutex);
             continue;
         }
 
-        // Procesar mensaje de reserva (RESERVA).
+        // Encolar mensaje de reserva (RESERVA) en la cola de su agente.
         if (tipo == MSG_RESERVA) {
             MensajeReserva msg;
             msg.tipo = tipo;
@@ -288,89 +375,159 @@ void *hiloRecepcion(void *arg) {
             if (r2 != sizeof(msg) - sizeof(tipo)) {
                 continue;
             }
-            pthread_mutex_lock(&mutex);
-
-            printf("[CONTROLADOR] Petición: agente=%s familia=%s hora=%d personas=%d\n",
-                    msg.nombre_agente,
-                    msg.nombre_familia,
-                    msg.hora_solicitada,
-                    msg.num_personas);
-            registrar_pipe_agente(msg.pipe_respuesta);
-
-            // Validaciones y procesamiento de la reserva.
-            if (msg.num_personas > aforoMax) {
-                procesar_reserva_negada(&msg, "Grupo supera aforo máximo");
-                pthread_mutex_unlock(&mutex);
-                continue;
-            }
-
-            if (msg.hora_solicitada > horaFinSim) {
-                procesar_reserva_negada(&msg, "Hora solicitada fuera del rango");
-                pthread_mutex_unlock(&mutex);
-                continue;
-            }
 
-            if (msg.hora_solicitada < hora_actual) {
-                int nh = buscar_bloque_dos_horas(msg.num_personas, hora_actual);
-                if (nh != -1) {
-                    procesar_reserva_extemporanea(&msg, nh);
-                } else {
-                    procesar_reserva_negada(&msg, "Extemporánea y sin cupo");
-                }
-                pthread_mutex_unlock(&mutex);
-                continue;
+            // La traza registra la llegada, no el momento en que se atiende.
+            uint64_t llegada_ns = traza_marca(&traza);
+            if (planificador_encolar(&planificador, &msg, llegada_ns) == -1) {
+                rechazar_ocupado(&msg, llegada_ns);
             }
-
-            if (puede_reservar_en_hora(msg.hora_solicitada, msg.num_personas)) {
-                procesar_reserva_ok(&msg);
-                pthread_mutex_unlock(&mutex);
-                continue;
-            }
-
-            int nh = buscar_bloque_dos_horas(msg.num_personas, hora_actual);
-            if (nh != -1) {
-                procesar_reserva_otras_horas(&msg, nh);
-            } else {
-                procesar_reserva_negada(&msg, "Sin bloques disponibles");
-            }
-
-            pthread_mutex_unlock(&mutex);
             continue;
         }
+
         // Mensaje desconocido.
         printf("[CONTROLADOR] Mensaje desconocido recibido.\n");
     }
-    
-    close(fd);
-    return NULL;
 }
 
-// Reporte final al terminar la simulación.
-static void reporte_final(void) {
-    printf("\n====== REPORTE FINAL ======\n");
-    printf(" Aceptadas:       %d\n", solicitudes_ok);
-    printf(" Extemporáneas:   %d\n", solicitudes_extemporaneas);
-    printf(" Reprogramadas:   %d\n", solicitudes_reprogramadas);
-    printf(" Negadas:         %d\n", solicitudes_negadas);
+// Al recibir SIGINT o SIGTERM, borrar la vista y el pipe principal (tienen
+// nombre y sobrevivirían al proceso) y terminar con la acción por defecto.
+static void manejar_terminacion(int sig) {
+    if (vista) { vista_desvincular(nombre_vista); }
+    unlink(pipe_principal);
+    raise(sig);
+}
 
-    int max = -1, min = 9999;
-    for (int h = horaIniSim; h <= horaFinSim; h++) {
-        if (ocupacion[h] > max) max = ocupacion[h];
-        if (ocupacion[h] < min) min = ocupacion[h];
+// Marcar que se pidió una instantánea; la toma el hilo de recepción.
+static void manejar_sigusr1(int sig) {
+    (void)sig;
+    instantanea_pedida = 1;
+}
+
+// Tomar una instantánea: el hijo escribe el reporte desde su copia del estado.
+// El mutex se tiene solo mientras dura el fork().
+static void tomar_instantanea(void) {
+    char ruta[256];
+
+    pthread_mutex_lock(&mutex);
+    total_instantaneas++;
+    int n = snprintf(ruta, sizeof(ruta), "%s/instantanea_%d_%d.json", dir_reportes, getpid(), total_instantaneas);
+    if (n >= (int)sizeof(ruta)) {
+        pthread_mutex_unlock(&mutex);
+        fprintf(stderr, "[CONTROLADOR] Directorio de reportes demasiado largo: %s\n", dir_reportes);
+        return;
     }
 
-    printf("\nHoras pico (%d): ", max);
-    for (int h = horaIniSim; h <= horaFinSim; h++) {
-        if (ocupacion[h] == max) printf("%d ", h);
+    DatosInstantanea d;
+    d.numero = total_instantaneas;
+    d.dia_actual = dia_actual;
+    d.hora_actual = hora_actual;
+    d.solicitudes_ocupado = solicitudes_ocupado;
+    d.estado = &estado;
+    d.agentes = estadisticas;
+    d.total_agentes = total_estadisticas;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Hijo: solo este hilo existe; no tocar locks ni stdio.
+        _exit(instantanea_escribir(ruta, &d) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
     }
+    pthread_mutex_unlock(&mutex);
 
-    printf("\nHoras valle (%d): ", min);
-    for (int h = horaIniSim; h <= horaFinSim; h++) {
-        if (ocupacion[h] == min) {
-            printf("%d ", h);
+    if (pid == -1) {
+        perror("[CONTROLADOR] Error creando proceso de instantánea");
+        return;
+    }
+    printf("[CONTROLADOR] Instantánea %d (día %d hora %d) -> %s\n",
+            total_instantaneas, d.dia_actual, d.hora_actual, ruta);
+}
+
+// Recoger los hijos de instantáneas que ya terminaron (o esperar a todos).
+static void recoger_instantaneas(int esperar) {
+    int status;
+    pid_t pid;
+
+    while ((pid = waitpid(-1, &status, esperar ? 0 : WNOHANG)) > 0) {
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            fprintf(stderr, "[CONTROLADOR] La instantánea del proceso %d falló\n", (int)pid);
         }
     }
-    printf("\n===========================\n");
+}
+
+// Hilo de recepción de mensajes de reserva.
+void *hiloRecepcion(void *arg) {
+    (void)arg;
+
+    // Habilitar cancelación asíncrona del hilo
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
+
+    // Solo este hilo recibe SIGUSR1, así no interrumpe el sleep() del reloj.
+    sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGUSR1);
+    pthread_sigmask(SIG_UNBLOCK, &senales, NULL);
+
+    // Abrir el pipe principal UNA SOLA VEZ, en modo NO BLOQUEANTE: así no se
+    // espera al primer agente y las instantáneas se atienden desde el inicio.
+    int fd = open(pipe_principal, O_RDONLY | O_NONBLOCK);
+    if (fd == -1) {
+        perror("[CONTROLADOR] Error abriendo pipe principal");
+        return NULL;
+    }
+
+    while (!debe_terminar) {
+        // ¿Ya se acabó la simulación?
+        pthread_mutex_lock(&mutex);
+        int fin = simulacion_terminada();
+        pthread_mutex_unlock(&mutex);
+
+        if (fin) {
+            break;
+        }
+
+        // Atender pedidos de instantánea y recoger las que terminaron.
+        if (instantanea_pedida) {
+            instantanea_pedida = 0;
+            tomar_instantanea();
+        }
+        recoger_instantaneas(0);
+
+        // Vaciar el pipe en las colas por agente.
+        int leidos = drenar_pipe_principal(fd);
+
+        // Atender una ronda de las colas y volver a revisar el pipe.
+        int atendidas = 0;
+        int ronda = planificador.total_colas * planificador.quantum;
+        MensajeReserva msg;
+        uint64_t llegada_ns;
+        while (atendidas < ronda && planificador_siguiente(&planificador, &msg, &llegada_ns)) {
+            atender_reserva(&msg, llegada_ns);
+            atendidas++;
+        }
+
+        if (leidos == 0 && atendidas == 0) {
+            // No había datos aún
+            struct timespec ts = {0, 50000000}; // 50ms
+            nanosleep(&ts, NULL);
+        }
+    }
+    
+    close(fd);
+    return NULL;
+}
+
+// Reporte final al terminar la simulación.
+static void reporte_final(void) {
+    printf("\n====== REPORTE FINAL ======\n");
+    printf(" Aceptadas:       %d\n", estado.solicitudes_ok);
+    printf(" Extemporáneas:   %d\n", estado.solicitudes_extemporaneas);
+    printf(" Reprogramadas:   %d\n", estado.solicitudes_reprogramadas);
+    printf(" Negadas:         %d\n", estado.solicitudes_negadas);
+    printf(" Ocupado:         %d\n", solicitudes_ocupado);
+    printf("\n");
+
+    imprimir_calendario();
+    printf("===========================\n");
 }
 
 // Enviar mensaje FIN a todos los agentes al terminar la simulación (no bloqueante).
@@ -379,16 +536,8 @@ static void enviar_fin_agentes(void) {
         const char *pipe_ag = pipes_agentes[i];
         if (!pipe_ag || pipe_ag[0] == '\0') continue;
 
-        // Abrir en modo bloqueante: el agente estará esperando lectura.
-        int fd = open(pipe_ag, O_WRONLY);
-        if (fd == -1) {
-            // No hay lector o pipe ya eliminado; saltar.
-            continue;
-        }
-
-        // Escribir FIN (bloqueante si necesario). Ignoramos errores locales.
-        (void)write(fd, "FIN", 3);
-        close(fd);
+        // El emisor lo entrega cuando el agente abra su pipe, o lo descarta.
+        emisor_encolar(pipe_ag, "FIN", 3);
     }
 }
 
@@ -400,7 +549,7 @@ int main(int argc, char *argv[]) {
     horaIniSim = horaFinSim = aforoMax = segHorasSim = -1;
 
     // Procesar argumentos de línea de comandos.
-    while ((opcion = getopt(argc, argv, "i:f:s:t:p:")) != -1) {
+    while ((opcion = getopt(argc, argv, "i:f:s:t:p:n:d:b:q:w:g:r:")) != -1) {
         switch (opcion) {
         case 'i': 
             horaIniSim = atoi(optarg); 
@@ -417,12 +566,35 @@ int main(int argc, char *argv[]) {
         case 'p': 
             pipe_principal = optarg; 
             break;
+        case 'n':
+            diasSim = atoi(optarg);
+            break;
+        case 'd':
+            diasHorizonte = atoi(optarg);
+            break;
+        case 'b':
+            maxPendientes = atoi(optarg);
+            break;
+        case 'q':
+            quantum = atoi(optarg);
+            break;
+        case 'w':
+            timeoutRespuestaMs = atoi(optarg);
+            break;
+        case 'g':
+            archivo_traza = optarg;
+            break;
+        case 'r':
+            dir_reportes = optarg;
+            break;
         }
     }
 
     // Validar parámetros obligatorios.
     if (!pipe_principal || horaIniSim < 7 || horaFinSim > 19 ||
-    horaIniSim >= horaFinSim || aforoMax <= 0 || segHorasSim <= 0) {
+    horaIniSim >= horaFinSim || aforoMax <= 0 || aforoMax > MAX_AFORO || segHorasSim <= 0 ||
+    diasSim <= 0 || diasHorizonte <= 0 ||
+    maxPendientes <= 0 || quantum <= 0 || timeoutRespuestaMs <= 0) {
         fprintf(stderr, "Parámetros inválidos.\n");
         return EXIT_FAILURE;
     }
@@ -436,14 +608,60 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    for (int i = 0; i < MAX_HORAS+2; i++) {
-        ocupacion[i] = 0;
+    if (reservas_iniciar(&estado, horaIniSim, horaFinSim, aforoMax, diasHorizonte) == -1) {
+        fprintf(stderr, "Sin memoria para un horizonte de %d días.\n", diasHorizonte);
+        return EXIT_FAILURE;
+    }
+    planificador_iniciar(&planificador, maxPendientes, quantum);
+
+    // Abrir traza si se pidió grabar.
+    if (archivo_traza && traza_abrir(&traza, archivo_traza, &estado) == -1) {
+        return EXIT_FAILURE;
     }
 
     // Crear pipe principal.
     crear_pipe(pipe_principal);
     hora_actual = horaIniSim;
 
+    // Publicar la ocupación para los agentes; si falla, solo pierden el filtrado previo.
+    vista_limpiar_huerfanas();
+    snprintf(nombre_vista, sizeof(nombre_vista), "%s%d", VISTA_PREFIJO, getpid());
+    vista = vista_crear(nombre_vista, &estado);
+    if (!vista) {
+        fprintf(stderr, "[CONTROLADOR] Continuando sin vista de ocupación.\n");
+    }
+
+    // Bloquear SIGUSR1 en todos los hilos salvo el de recepción, que lo desbloquea.
+    sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &senales, NULL);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = manejar_sigusr1;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+
+    // SA_RESETHAND: el manejador vuelve a levantar la señal con la acción por defecto.
+    sa.sa_handler = manejar_terminacion;
+    sa.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // Un agente que cierra su pipe a mitad de una escritura no debe matar al
+    // controlador: con SIGPIPE ignorada, write() falla con EPIPE y el emisor
+    // descarta solo ese mensaje.
+    signal(SIGPIPE, SIG_IGN);
+
+    // Crear hilo emisor de respuestas.
+    if (emisor_iniciar(timeoutRespuestaMs) == -1) {
+        vista_destruir(vista, nombre_vista);
+        unlink(pipe_principal);
+        return EXIT_FAILURE;
+    }
+
     // Crear hilos de reloj y recepción.
     pthread_t thReloj, thRecv;
     pthread_create(&thReloj, NULL, hiloReloj, NULL);
@@ -458,11 +676,17 @@ int main(int argc, char *argv[]) {
     // Indicar al hilo de recepción que debe terminar y esperar a que lo haga
     debe_terminar = 1;
     pthread_join(thRecv, NULL);
+    recoger_instantaneas(1);
 
     // Enviar FIN a todos los agentes (ahora los agentes estarán esperando la notificación)
+    // y esperar a que el emisor entregue todo lo pendiente.
     enviar_fin_agentes();
+    emisor_terminar();
 
     reporte_final();
+    traza_cerrar(&traza, &estado);
+    vista_destruir(vista, nombre_vista);
+    reservas_liberar(&estado);
 
     unlink(pipe_principal);
     return 0;
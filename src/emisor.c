@@ -0,0 +1,290 @@
+/**
+ *  @file emisor.c
+ *  @brief Hilo que escribe las respuestas del controlador a los agentes.
+ *
+ *  Las decisiones no escriben directamente en el pipe del agente: dejan la
+ *  respuesta en una cola de salida y este hilo la entrega. Cada pipe se abre en
+ *  modo no bloqueante; si el agente todavía no lo abrió para lectura, el envío
+ *  se reintenta con una espera creciente hasta un tiempo límite, y mientras
+ *  tanto el hilo sigue entregando a los demás agentes. Así un agente lento solo
+ *  retrasa sus propias respuestas.
+ *
+ *  El envío se hace sin tener el mutex de la cola, así que encolar (lo que hace
+ *  el controlador con su propio mutex tomado) nunca espera a un open() o
+ *  write() de este hilo.
+ *
+ *  Los mensajes para un mismo agente se entregan en el orden en que se
+ *  encolaron: solo se intenta el marcado como 'primero' de cada pipe. Cada agente puede tener a lo sumo MAX_SALIDA_POR_PIPE mensajes
+ *  pendientes: al pasarse se descarta el más antiguo de ese mismo agente. Si la
+ *  cola completa se llena, se descarta el más antiguo del agente con más
+ *  pendientes, de modo que el que no lee pierde sus respuestas y no las de
+ *  los demás.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "emisor.h"
+
+// Esperas entre intentos de apertura (ms).
+#define ESPERA_INICIAL_MS 2
+#define ESPERA_MAXIMA_MS 100
+
+// Cola de salida, en orden de llegada.
+static MensajeSalida salida[MAX_SALIDA];
+static int total_salida = 0;
+
+static unsigned long siguiente_id = 1;
+static unsigned long id_en_vuelo = 0;     // Mensaje que se está enviando (0: ninguno).
+
+static int timeoutMs = 5000;
+static int terminar = 0;
+static pthread_t thEmisor;
+
+// Mutex y condición de la cola de salida.
+static pthread_mutex_t mutex_salida = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_salida;
+
+// Sumar milisegundos a un instante.
+static void sumar_ms(struct timespec *ts, long ms) {
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// ¿El instante a es anterior al b?
+static int antes(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+// Quitar el mensaje i conservando el orden de los demás. Si era el primero de
+// su pipe, el siguiente para ese pipe pasa a serlo.
+static void quitar(int i) {
+    if (salida[i].primero) {
+        for (int j = i + 1; j < total_salida; j++) {
+            if (strcmp(salida[j].pipe_destino, salida[i].pipe_destino) == 0) {
+                salida[j].primero = 1;
+                break;
+            }
+        }
+    }
+    memmove(&salida[i], &salida[i + 1], (total_salida - i - 1) * sizeof(salida[0]));
+    total_salida--;
+}
+
+// Posición actual del mensaje con ese id (-1 si ya no está).
+static int buscar_id(unsigned long id) {
+    for (int i = 0; i < total_salida; i++) {
+        if (salida[i].id == id) { return i; }
+    }
+    return -1;
+}
+
+// Cuántos mensajes hay pendientes para un pipe y cuál es el más antiguo que se
+// puede descartar (el que se está enviando no).
+static int contar_pipe(const char *pipe_destino, int *descartable) {
+    int cantidad = 0;
+    *descartable = -1;
+    for (int i = 0; i < total_salida; i++) {
+        if (strcmp(salida[i].pipe_destino, pipe_destino) == 0) {
+            if (*descartable == -1 && salida[i].id != id_en_vuelo) { *descartable = i; }
+            cantidad++;
+        }
+    }
+    return cantidad;
+}
+
+// Hacer lugar para un mensaje a 'pipe_destino' y dejar en 'propios' cuántos
+// tenía pendientes. Devuelve -1 si el que sobra es justamente ese mensaje (su
+// agente es el que más pendientes tiene).
+static int hacer_lugar(const char *pipe_destino, int *propios) {
+    int descartable;
+    *propios = contar_pipe(pipe_destino, &descartable);
+
+    // Límite por agente: se pierde su respuesta más antigua.
+    if (*propios >= MAX_SALIDA_POR_PIPE && descartable != -1) {
+        fprintf(stderr, "[EMISOR] Demasiados mensajes para %s; se descarta el más antiguo\n", pipe_destino);
+        quitar(descartable);
+        return 0;
+    }
+    if (total_salida < MAX_SALIDA) { return 0; }
+
+    // Cola llena: descartar del agente con más pendientes (se cuenta cada pipe
+    // una vez, desde su primer mensaje).
+    int peor = -1, peor_cantidad = *propios;
+    for (int i = 0; i < total_salida; i++) {
+        if (!salida[i].primero) { continue; }
+
+        int d;
+        int cantidad = contar_pipe(salida[i].pipe_destino, &d);
+        if (cantidad > peor_cantidad && d != -1) {
+            peor = d;
+            peor_cantidad = cantidad;
+        }
+    }
+    if (peor == -1) { return -1; }
+
+    fprintf(stderr, "[EMISOR] Cola de salida llena; se descarta un mensaje para %s\n", salida[peor].pipe_destino);
+    quitar(peor);
+    return 0;
+}
+
+// Intentar entregar un mensaje. Devuelve 1 si ya no hay que reintentarlo.
+static int intentar_envio(MensajeSalida *m, const struct timespec *ahora) {
+    int fd = open(m->pipe_destino, O_WRONLY | O_NONBLOCK);
+
+    if (fd != -1) {
+        ssize_t w = write(fd, m->datos, m->tam);
+        int error = errno;
+        close(fd);
+
+        if (w == (ssize_t)m->tam) { return 1; }
+
+        // EPIPE: el agente cerró el pipe (SIGPIPE se ignora en el controlador).
+        if (w != -1 || error != EAGAIN) {
+            fprintf(stderr, "[EMISOR] Error escribiendo en %s\n", m->pipe_destino);
+            return 1;
+        }
+    } else if (errno != ENXIO) {
+        // El pipe no existe o no se puede abrir; reintentar no ayuda.
+        perror("[EMISOR] Error abriendo pipe del agente");
+        return 1;
+    }
+
+    // Sin lector todavía (ENXIO) o pipe lleno (EAGAIN).
+    if (antes(&m->limite, ahora)) {
+        fprintf(stderr, "[EMISOR] Mensaje para %s descartado: sin lector tras %d ms\n",
+                m->pipe_destino, timeoutMs);
+        return 1;
+    }
+
+    m->proximo = *ahora;
+    sumar_ms(&m->proximo, m->espera_ms);
+    m->espera_ms *= 2;
+    if (m->espera_ms > ESPERA_MAXIMA_MS) { m->espera_ms = ESPERA_MAXIMA_MS; }
+    return 0;
+}
+
+// Hilo que entrega los mensajes de la cola de salida.
+static void *hiloEmisor(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&mutex_salida);
+    while (!terminar || total_salida > 0) {
+        struct timespec ahora;
+        clock_gettime(CLOCK_MONOTONIC, &ahora);
+
+        struct timespec despertar = ahora;
+        sumar_ms(&despertar, ESPERA_MAXIMA_MS);
+
+        int i = 0;
+        while (i < total_salida) {
+            MensajeSalida *m = &salida[i];
+
+            // Respetar el orden por agente: esperar a que salga el anterior.
+            if (!m->primero) {
+                i++;
+                continue;
+            }
+
+            if (antes(&ahora, &m->proximo)) {
+                if (antes(&m->proximo, &despertar)) { despertar = m->proximo; }
+                i++;
+                continue;
+            }
+
+            // Enviar una copia sin el mutex. El mensaje no se descarta mientras
+            // está en vuelo, pero puede cambiar de posición: se busca por id.
+            MensajeSalida copia = *m;
+            id_en_vuelo = copia.id;
+            pthread_mutex_unlock(&mutex_salida);
+
+            int listo = intentar_envio(&copia, &ahora);
+
+            pthread_mutex_lock(&mutex_salida);
+            id_en_vuelo = 0;
+            i = buscar_id(copia.id);
+
+            if (listo) {
+                quitar(i);
+                continue;
+            }
+
+            salida[i].proximo = copia.proximo;
+            salida[i].espera_ms = copia.espera_ms;
+            if (antes(&copia.proximo, &despertar)) { despertar = copia.proximo; }
+            i++;
+        }
+
+        if (total_salida == 0 && !terminar) {
+            pthread_cond_wait(&cond_salida, &mutex_salida);
+        } else if (total_salida > 0) {
+            pthread_cond_timedwait(&cond_salida, &mutex_salida, &despertar);
+        }
+    }
+    pthread_mutex_unlock(&mutex_salida);
+    return NULL;
+}
+
+// Crear el hilo emisor.
+int emisor_iniciar(int timeout_ms) {
+    timeoutMs = timeout_ms;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond_salida, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&thEmisor, NULL, hiloEmisor, NULL) != 0) {
+        fprintf(stderr, "[EMISOR] No se pudo crear el hilo emisor\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Encolar un mensaje para un agente. Devuelve -1 si se descartó.
+int emisor_encolar(const char *pipe_destino, const void *datos, size_t tam) {
+    if (!pipe_destino || pipe_destino[0] == '\0' || tam > MAX_DATOS_SALIDA) { return -1; }
+
+    pthread_mutex_lock(&mutex_salida);
+    int propios;
+    if (hacer_lugar(pipe_destino, &propios) == -1) {
+        pthread_mutex_unlock(&mutex_salida);
+        fprintf(stderr, "[EMISOR] Cola de salida llena; mensaje para %s descartado\n", pipe_destino);
+        return -1;
+    }
+
+    MensajeSalida *m = &salida[total_salida++];
+    memset(m->pipe_destino, 0, sizeof(m->pipe_destino));
+    strncpy(m->pipe_destino, pipe_destino, MAX_PIPE_NAME - 1);
+    memcpy(m->datos, datos, tam);
+    m->tam = tam;
+    m->espera_ms = ESPERA_INICIAL_MS;
+    m->id = siguiente_id++;
+    m->primero = (propios == 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &m->proximo);
+    m->limite = m->proximo;
+    sumar_ms(&m->limite, timeoutMs);
+
+    pthread_cond_signal(&cond_salida);
+    pthread_mutex_unlock(&mutex_salida);
+    return 0;
+}
+
+// Entregar (o descartar por tiempo) lo pendiente y terminar el hilo.
+void emisor_terminar(void) {
+    pthread_mutex_lock(&mutex_salida);
+    terminar = 1;
+    pthread_cond_signal(&cond_salida);
+    pthread_mutex_unlock(&mutex_salida);
+
+    pthread_join(thEmisor, NULL);
+}
@@ -0,0 +1,30 @@
+#ifndef EMISOR_H
+#define EMISOR_H
+
+#include <stddef.h>
+#include <time.h>
+#include "../include/estructuras.h"
+
+// Constantes.
+#define MAX_SALIDA 512
+#define MAX_SALIDA_POR_PIPE 16
+#define MAX_DATOS_SALIDA 256
+
+// Mensaje pendiente de escribir en el pipe de un agente.
+typedef struct {
+    char pipe_destino[MAX_PIPE_NAME];
+    char datos[MAX_DATOS_SALIDA];
+    size_t tam;
+    struct timespec limite;       // Después de esto se descarta.
+    struct timespec proximo;      // Próximo intento de apertura.
+    long espera_ms;               // Espera actual entre intentos.
+    unsigned long id;             // Identifica el mensaje aunque cambie de posición.
+    int primero;                  // Es el más antiguo pendiente para su pipe.
+} MensajeSalida;
+
+// Funciones del emisor de respuestas.
+int emisor_iniciar(int timeout_ms);
+int emisor_encolar(const char *pipe_destino, const void *datos, size_t tam);
+void emisor_terminar(void);
+
+#endif
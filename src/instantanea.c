@@ -0,0 +1,142 @@
+/**
+ *  @file instantanea.c
+ *  @brief Reporte JSON del estado del controlador.
+ *
+ *  Lo escribe un proceso hijo creado con fork(): el hijo tiene una copia del
+ *  estado (copy-on-write) tomada con el mutex del controlador tomado, así que
+ *  los números son consistentes aunque el padre siga atendiendo reservas.
+ *
+ *  Como el hijo de un proceso con hilos solo debe usar funciones que no tomen
+ *  locks, aquí no se usa stdio ni malloc: el texto se arma con snprintf en un
+ *  búfer fijo y se escribe con write(). El archivo se escribe con extensión
+ *  .tmp y se renombra al final, para que nunca se lea un reporte a medias. El
+ *  temporal se crea en exclusiva y sin seguir enlaces simbólicos, porque su
+ *  nombre es predecible y el directorio puede ser /tmp.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "instantanea.h"
+
+// Búfer de salida hacia un descriptor.
+typedef struct {
+    int fd;
+    char buf[4096];
+    size_t usado;
+    int error;
+} Salida;
+
+// Escribir lo acumulado en el búfer.
+static void vaciar(Salida *s) {
+    size_t escrito = 0;
+    while (!s->error && escrito < s->usado) {
+        ssize_t w = write(s->fd, s->buf + escrito, s->usado - escrito);
+        if (w <= 0) {
+            s->error = 1;
+            break;
+        }
+        escrito += w;
+    }
+    s->usado = 0;
+}
+
+// Agregar texto con formato. Si no cabe, se vacía el búfer y se reintenta.
+static void escribir(Salida *s, const char *fmt, ...) {
+    va_list args;
+
+    for (int intento = 0; intento < 2 && !s->error; intento++) {
+        va_start(args, fmt);
+        int n = vsnprintf(s->buf + s->usado, sizeof(s->buf) - s->usado, fmt, args);
+        va_end(args);
+
+        if (n < 0) { break; }
+        if ((size_t)n < sizeof(s->buf) - s->usado) {
+            s->usado += n;
+            return;
+        }
+        vaciar(s);
+    }
+    s->error = 1;
+}
+
+// Agregar un texto entre comillas, escapando lo que JSON no admite.
+static void escribir_texto(Salida *s, const char *texto) {
+    escribir(s, "\"");
+    for (const unsigned char *c = (const unsigned char *)texto; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            escribir(s, "\\%c", *c);
+        } else if (*c < 0x20) {
+            escribir(s, "\\u%04x", *c);
+        } else {
+            escribir(s, "%c", *c);
+        }
+    }
+    escribir(s, "\"");
+}
+
+// Escribir el reporte completo.
+static void escribir_reporte(Salida *s, const DatosInstantanea *d) {
+    const EstadoReservas *e = d->estado;
+
+    escribir(s, "{\n");
+    escribir(s, "  \"instantanea\": %d,\n", d->numero);
+    escribir(s, "  \"dia_actual\": %d,\n", d->dia_actual);
+    escribir(s, "  \"hora_actual\": %d,\n", d->hora_actual);
+    escribir(s, "  \"parametros\": {\"hora_inicio\": %d, \"hora_fin\": %d, \"aforo_max\": %d, \"horizonte\": %d},\n",
+             e->horaIniSim, e->horaFinSim, e->aforoMax, e->horizonte);
+    escribir(s, "  \"solicitudes\": {\"aceptadas\": %d, \"extemporaneas\": %d, \"reprogramadas\": %d, "
+             "\"negadas\": %d, \"ocupado\": %d},\n",
+             e->solicitudes_ok, e->solicitudes_extemporaneas, e->solicitudes_reprogramadas,
+             e->solicitudes_negadas, d->solicitudes_ocupado);
+
+    // Ocupación por día y hora: personas[i] corresponde a la hora hora_inicio + i.
+    escribir(s, "  \"ocupacion\": [\n");
+    for (int dia = e->dia_base; dia < e->dia_base + e->horizonte; dia++) {
+        const unsigned short *slots = reservas_dia(e, dia);
+        escribir(s, "    {\"dia\": %d, \"personas\": [", dia);
+        for (int i = 0; i < e->horas_dia; i++) {
+            escribir(s, i ? ", %d" : "%d", slots[i]);
+        }
+        escribir(s, "]}%s\n", dia + 1 < e->dia_base + e->horizonte ? "," : "");
+    }
+    escribir(s, "  ],\n");
+
+    // Resultados por agente.
+    escribir(s, "  \"agentes\": [\n");
+    for (int i = 0; i < d->total_agentes; i++) {
+        const EstadisticasAgente *a = &d->agentes[i];
+        escribir(s, "    {\"nombre\": ");
+        escribir_texto(s, a->nombre_agente);
+        escribir(s, ", \"aceptadas\": %d, \"extemporaneas\": %d, \"reprogramadas\": %d, "
+                 "\"negadas\": %d, \"ocupado\": %d}%s\n",
+                 a->ok, a->extemporaneas, a->reprogramadas, a->negadas, a->ocupado,
+                 i + 1 < d->total_agentes ? "," : "");
+    }
+    escribir(s, "  ]\n");
+    escribir(s, "}\n");
+}
+
+// Escribir la instantánea en 'ruta'. Devuelve 0 si se escribió completa.
+int instantanea_escribir(const char *ruta, const DatosInstantanea *d) {
+    char temporal[300];
+    if (snprintf(temporal, sizeof(temporal), "%s.tmp", ruta) >= (int)sizeof(temporal)) { return -1; }
+
+    Salida s;
+    s.fd = open(temporal, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0644);
+    s.usado = 0;
+    s.error = 0;
+    if (s.fd == -1) { return -1; }
+
+    escribir_reporte(&s, d);
+    vaciar(&s);
+
+    if (close(s.fd) == -1) { s.error = 1; }
+    if (s.error || rename(temporal, ruta) == -1) {
+        unlink(temporal);
+        return -1;
+    }
+    return 0;
+}
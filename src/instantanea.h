@@ -0,0 +1,30 @@
+#ifndef INSTANTANEA_H
+#define INSTANTANEA_H
+
+#include "reservas.h"
+
+// Resultados de las solicitudes de un agente.
+typedef struct {
+    char nombre_agente[MAX_NOMBRE];
+    int ok;
+    int reprogramadas;
+    int extemporaneas;
+    int negadas;
+    int ocupado;
+} EstadisticasAgente;
+
+// Todo lo que entra en una instantánea.
+typedef struct {
+    int numero;
+    int dia_actual;
+    int hora_actual;
+    int solicitudes_ocupado;
+    const EstadoReservas *estado;
+    const EstadisticasAgente *agentes;
+    int total_agentes;
+} DatosInstantanea;
+
+// Funciones de la instantánea.
+int instantanea_escribir(const char *ruta, const DatosInstantanea *d);
+
+#endif
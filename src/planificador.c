@@ -0,0 +1,94 @@
+/**
+ *  @file planificador.c
+ *  @brief Colas por agente con atención justa para el controlador.
+ *
+ *  Todos los agentes escriben en el mismo pipe principal. Para que un agente
+ *  que envía muchas solicitudes no deje esperando a los demás, el controlador
+ *  vacía el pipe en una cola por agente y las atiende con deficit round-robin:
+ *  en cada turno un agente recibe `quantum` créditos y cada solicitud atendida
+ *  consume uno.
+ *
+ *  El total de solicitudes encoladas está limitado; por encima del límite (o
+ *  si la cola del agente está llena) la solicitud se rechaza de inmediato para
+ *  que el controlador responda "ocupado" en lugar de acumular latencia.
+ */
+
+#include <string.h>
+#include "planificador.h"
+
+// Inicializar el planificador sin colas.
+void planificador_iniciar(Planificador *p, int max_pendientes, int quantum) {
+    memset(p, 0, sizeof(*p));
+    p->max_pendientes = max_pendientes;
+    p->quantum = quantum;
+}
+
+// Buscar la cola de un agente, creándola si no existe.
+static ColaAgente *buscar_cola(Planificador *p, const char *pipeN) {
+    for (int i = 0; i < p->total_colas; i++) {
+        if (strcmp(p->colas[i].pipe_respuesta, pipeN) == 0) {
+            return &p->colas[i];
+        }
+    }
+
+    // Reutilizar la cola vacía de un agente inactivo (cada proceso agente usa
+    // un pipe distinto). Una cola vacía no tiene créditos, así que el turno
+    // sigue siendo válido aunque apunte a ella.
+    ColaAgente *c = NULL;
+    for (int i = 0; i < p->total_colas && !c; i++) {
+        if (p->colas[i].cantidad == 0) { c = &p->colas[i]; }
+    }
+
+    if (!c) {
+        if (p->total_colas == MAX_COLAS_AGENTE) { return NULL; }
+        c = &p->colas[p->total_colas++];
+    }
+    memset(c, 0, sizeof(*c));
+    strncpy(c->pipe_respuesta, pipeN, MAX_PIPE_NAME - 1);
+    return c;
+}
+
+// Encolar una solicitud. Devuelve -1 si se debe rechazar por ocupado.
+int planificador_encolar(Planificador *p, const MensajeReserva *msg, uint64_t llegada_ns) {
+    if (p->pendientes >= p->max_pendientes) { return -1; }
+
+    ColaAgente *c = buscar_cola(p, msg->pipe_respuesta);
+    if (!c || c->cantidad == MAX_POR_AGENTE) { return -1; }
+
+    c->mensajes[(c->inicio + c->cantidad) % MAX_POR_AGENTE] = *msg;
+    c->llegadas[(c->inicio + c->cantidad) % MAX_POR_AGENTE] = llegada_ns;
+    c->cantidad++;
+    p->pendientes++;
+    return 0;
+}
+
+// Sacar la siguiente solicitud a atender y su instante de llegada.
+// Devuelve 0 si no hay pendientes.
+int planificador_siguiente(Planificador *p, MensajeReserva *msg, uint64_t *llegada_ns) {
+    if (p->pendientes == 0) { return 0; }
+
+    while (1) {
+        ColaAgente *c = &p->colas[p->turno];
+
+        // El agente en turno aún tiene créditos y solicitudes.
+        if (c->cantidad > 0 && c->deficit > 0) {
+            *msg = c->mensajes[c->inicio];
+            *llegada_ns = c->llegadas[c->inicio];
+            c->inicio = (c->inicio + 1) % MAX_POR_AGENTE;
+            c->cantidad--;
+            c->deficit--;
+            p->pendientes--;
+
+            // Una cola vacía no acumula créditos para el siguiente turno.
+            if (c->cantidad == 0) { c->deficit = 0; }
+            return 1;
+        }
+
+        // Turno agotado: pasar al siguiente agente y darle su quantum.
+        if (c->cantidad == 0) { c->deficit = 0; }
+        p->turno = (p->turno + 1) % p->total_colas;
+
+        c = &p->colas[p->turno];
+        if (c->cantidad > 0) { c->deficit += p->quantum; }
+    }
+}
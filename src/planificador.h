@@ -0,0 +1,36 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <stdint.h>
+#include "../include/estructuras.h"
+
+// Constantes.
+#define MAX_COLAS_AGENTE 200
+#define MAX_POR_AGENTE 16
+
+// Cola de solicitudes pendientes de un agente (identificado por su pipe).
+typedef struct {
+    char pipe_respuesta[MAX_PIPE_NAME];
+    MensajeReserva mensajes[MAX_POR_AGENTE];
+    uint64_t llegadas[MAX_POR_AGENTE];      // Instante de llegada de cada mensaje.
+    int inicio;
+    int cantidad;
+    int deficit;
+} ColaAgente;
+
+// Colas por agente atendidas con deficit round-robin.
+typedef struct {
+    ColaAgente colas[MAX_COLAS_AGENTE];
+    int total_colas;
+    int turno;
+    int pendientes;
+    int max_pendientes;
+    int quantum;
+} Planificador;
+
+// Funciones del planificador.
+void planificador_iniciar(Planificador *p, int max_pendientes, int quantum);
+int planificador_encolar(Planificador *p, const MensajeReserva *msg, uint64_t llegada_ns);
+int planificador_siguiente(Planificador *p, MensajeReserva *msg, uint64_t *llegada_ns);
+
+#endif
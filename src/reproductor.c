@@ -0,0 +1,276 @@
+/**
+ *  @file reproductor.c
+ *  @brief Reproduce una traza grabada por el controlador.
+ *
+ *  Este programa lee una traza binaria (ver `controlador -g`) y vuelve a pasar
+ *  cada reserva por la misma lógica de decisión del controlador, sin FIFOs ni
+ *  esperas de reloj: cada registro lleva el día y la hora simulados con los que
+ *  se decidió (el calendario se avanza al día del registro antes de decidir),
+ *  así que el resultado es determinista.
+ *
+ *      Modos:
+ *  - **verificar:** reproduce una vez y compara cada respuesta con la grabada,
+ *    mostrando las diferencias.
+ *  - **rapido:** reproduce la traza completa varias veces lo más rápido posible
+ *    y reporta el costo por decisión; al final verifica el estado resultante.
+ *
+ *  En ambos modos se comparan la ocupación final y los contadores contra el
+ *  resumen grabado. El programa termina con código 0 solo si todo coincide.
+ *
+ *      Parámetros esperados:
+ *   -t <archivoTraza> Traza grabada por el controlador.
+ *   -m <modo> "verificar" (por defecto) o "rapido".
+ *   -n <repeticiones> Repeticiones en modo rápido (por defecto 1000).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "reservas.h"
+#include "traza.h"
+
+// Máximo de diferencias a mostrar en modo verificar.
+#define MAX_DIFERENCIAS 20
+
+// Tiempo monotónico en nanosegundos.
+static double ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Reconstruir el mensaje de reserva a partir de un registro.
+static void registro_a_mensaje(const RegistroTraza *reg, MensajeReserva *msg) {
+    memset(msg, 0, sizeof(*msg));
+    msg->tipo = MSG_RESERVA;
+    strncpy(msg->nombre_agente, reg->nombre_agente, MAX_NOMBRE - 1);
+    strncpy(msg->nombre_familia, reg->nombre_familia, MAX_NOMBRE - 1);
+    msg->dia_solicitado = reg->dia_solicitado;
+    msg->hora_solicitada = reg->hora_solicitada;
+    msg->num_personas = reg->num_personas;
+}
+
+// Avanzar el calendario hasta el día dado, como lo hace el reloj del controlador.
+static void avanzar_hasta(EstadoReservas *e, int dia) {
+    while (e->dia_base < dia) {
+        reservas_avanzar_dia(e);
+    }
+}
+
+// Comparar el estado final contra el resumen grabado.
+static int verificar_resumen(EstadoReservas *e, const ResumenTraza *res, const unsigned short *ocupacion) {
+    int errores = 0;
+
+    // El reloj pudo avanzar días después del último mensaje grabado.
+    avanzar_hasta(e, res->dia_base);
+
+    if (e->dia_base != res->dia_base || e->horizonte != res->horizonte || e->horas_dia != res->horas_dia) {
+        printf("[REPRODUCTOR] Calendario distinto: día base %d/%d, horizonte %d/%d, horas %d/%d (obtenido/grabado)\n",
+                e->dia_base, res->dia_base, e->horizonte, res->horizonte, e->horas_dia, res->horas_dia);
+        return errores + 1;
+    }
+
+    if (e->solicitudes_ok != res->solicitudes_ok ||
+        e->solicitudes_extemporaneas != res->solicitudes_extemporaneas ||
+        e->solicitudes_reprogramadas != res->solicitudes_reprogramadas ||
+        e->solicitudes_negadas != res->solicitudes_negadas) {
+        printf("[REPRODUCTOR] Contadores distintos: ok=%d/%d ext=%d/%d rep=%d/%d neg=%d/%d (obtenido/grabado)\n",
+                e->solicitudes_ok, res->solicitudes_ok,
+                e->solicitudes_extemporaneas, res->solicitudes_extemporaneas,
+                e->solicitudes_reprogramadas, res->solicitudes_reprogramadas,
+                e->solicitudes_negadas, res->solicitudes_negadas);
+        errores++;
+    }
+
+    for (int d = 0; d < res->horizonte; d++) {
+        for (int i = 0; i < res->horas_dia; i++) {
+            int obtenido = reservas_ocupacion(e, res->dia_base + d, e->horaIniSim + i);
+            int grabado = ocupacion[d * res->horas_dia + i];
+            if (obtenido != grabado) {
+                printf("[REPRODUCTOR] Ocupación distinta el día %d a las %d: %d/%d (obtenido/grabado)\n",
+                        res->dia_base + d, e->horaIniSim + i, obtenido, grabado);
+                errores++;
+            }
+        }
+    }
+    return errores;
+}
+
+// Programa principal.
+int main(int argc, char *argv[]) {
+    const char *archivo_traza = NULL;
+    const char *modo = "verificar";
+    long repeticiones = 1000;
+
+    // Procesar argumentos.
+    int opcion;
+    while ((opcion = getopt(argc, argv, "t:m:n:")) != -1) {
+        switch (opcion) {
+        case 't':
+            archivo_traza = optarg;
+            break;
+        case 'm':
+            modo = optarg;
+            break;
+        case 'n':
+            repeticiones = atol(optarg);
+            break;
+        default:
+            fprintf(stderr, "Uso: %s -t <archivoTraza> [-m verificar|rapido] [-n repeticiones]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int rapido = (strcmp(modo, "rapido") == 0);
+    if (!archivo_traza || (!rapido && strcmp(modo, "verificar") != 0) || repeticiones <= 0) {
+        fprintf(stderr, "Parámetros inválidos.\nUso: %s -t <archivoTraza> [-m verificar|rapido] [-n repeticiones]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *f = fopen(archivo_traza, "rb");
+    if (!f) {
+        perror("[REPRODUCTOR] No se pudo abrir la traza");
+        return EXIT_FAILURE;
+    }
+
+    CabeceraTraza cab;
+    if (traza_leer_cabecera(f, &cab) == -1) {
+        fprintf(stderr, "[REPRODUCTOR] %s no es una traza válida (o es de otra versión)\n", archivo_traza);
+        fclose(f);
+        return EXIT_FAILURE;
+    }
+
+    // Cargar todos los registros en memoria para no medir la lectura del disco.
+    size_t total = 0, capacidad = 1024;
+    RegistroTraza *registros = malloc(capacidad * sizeof(*registros));
+    ResumenTraza resumen;
+    unsigned short *ocupacion_final = NULL;
+    int holas = 0;
+    int ocupados = 0;
+
+    RegistroTraza reg;
+    while (registros && traza_leer_registro(f, &reg) == 0) {
+        if (reg.tipo == TRAZA_CIERRE) {
+            ocupacion_final = traza_leer_resumen(f, &resumen);
+            break;
+        }
+        if (reg.tipo == MSG_HOLA) {
+            holas++;
+            continue;
+        }
+        if (reg.tipo != MSG_RESERVA) {
+            continue;
+        }
+        // Los rechazos por ocupado no pasaron por la lógica de decisión.
+        if (reg.resultado == RESERVA_OCUPADO) {
+            ocupados++;
+            continue;
+        }
+        if (total == capacidad) {
+            capacidad *= 2;
+            RegistroTraza *nuevo = realloc(registros, capacidad * sizeof(*registros));
+            if (!nuevo) {
+                free(registros);
+                registros = NULL;
+                break;
+            }
+            registros = nuevo;
+        }
+        registros[total++] = reg;
+    }
+    fclose(f);
+
+    if (!registros) {
+        fprintf(stderr, "[REPRODUCTOR] Sin memoria para cargar la traza\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("[REPRODUCTOR] Traza %s: horas %d-%d, aforo %d, horizonte %d días, %zu reservas, %d ocupado, %d HELLO\n",
+            archivo_traza, cab.horaIniSim, cab.horaFinSim, cab.aforoMax, cab.horizonte, total, ocupados, holas);
+    if (!ocupacion_final) {
+        printf("[REPRODUCTOR] La traza no tiene resumen final (¿controlador interrumpido?)\n");
+    }
+
+    // Reconstruir los mensajes fuera de la zona medida.
+    EstadoReservas estado, vacio;
+    MensajeReserva *mensajes = malloc((total ? total : 1) * sizeof(*mensajes));
+    if (!mensajes ||
+        reservas_iniciar(&estado, cab.horaIniSim, cab.horaFinSim, cab.aforoMax, cab.horizonte) == -1 ||
+        reservas_iniciar(&vacio, cab.horaIniSim, cab.horaFinSim, cab.aforoMax, cab.horizonte) == -1) {
+        fprintf(stderr, "[REPRODUCTOR] Sin memoria para cargar la traza\n");
+        free(mensajes);
+        free(registros);
+        free(ocupacion_final);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < total; i++) {
+        registro_a_mensaje(&registros[i], &mensajes[i]);
+    }
+
+    RespuestaControlador respuesta;
+    int errores = 0;
+
+    if (!rapido) {
+        // Reproducir una vez comparando cada respuesta.
+        for (size_t i = 0; i < total; i++) {
+            avanzar_hasta(&estado, registros[i].dia_actual);
+            reservas_decidir(&estado, &mensajes[i], registros[i].dia_actual, registros[i].hora_actual, &respuesta);
+
+            if ((int)respuesta.tipo != registros[i].resultado ||
+                respuesta.dia_asignado != registros[i].dia_asignado ||
+                respuesta.hora_asignada != registros[i].hora_asignada) {
+                if (errores < MAX_DIFERENCIAS) {
+                    printf("[REPRODUCTOR] #%zu agente=%s familia=%s día=%d hora=%d personas=%d: "
+                           "tipo=%d día=%d hora=%d, grabado tipo=%d día=%d hora=%d\n",
+                            i, registros[i].nombre_agente, registros[i].nombre_familia,
+                            registros[i].dia_solicitado, registros[i].hora_solicitada, registros[i].num_personas,
+                            respuesta.tipo, respuesta.dia_asignado, respuesta.hora_asignada,
+                            registros[i].resultado, registros[i].dia_asignado, registros[i].hora_asignada);
+                }
+                errores++;
+            }
+        }
+    } else {
+        // Reproducir varias veces midiendo solo las decisiones.
+        double t0 = ahora_ns();
+        for (long r = 0; r < repeticiones; r++) {
+            reservas_copiar(&estado, &vacio);
+            for (size_t i = 0; i < total; i++) {
+                avanzar_hasta(&estado, registros[i].dia_actual);
+                reservas_decidir(&estado, &mensajes[i], registros[i].dia_actual, registros[i].hora_actual, &respuesta);
+            }
+        }
+        double t1 = ahora_ns();
+
+        double decisiones = (double)total * repeticiones;
+        if (decisiones > 0) {
+            printf("[REPRODUCTOR] %.0f decisiones en %.3f ms: %.1f ns/decisión, %.0f decisiones/s\n",
+                    decisiones, (t1 - t0) / 1e6, (t1 - t0) / decisiones, decisiones * 1e9 / (t1 - t0));
+        }
+    }
+
+    if (ocupacion_final) {
+        errores += verificar_resumen(&estado, &resumen, ocupacion_final);
+    }
+
+    reservas_liberar(&estado);
+    reservas_liberar(&vacio);
+    free(ocupacion_final);
+    free(mensajes);
+    free(registros);
+
+    if (errores) {
+        printf("[REPRODUCTOR] ❌ %d diferencias con la traza\n", errores);
+        return EXIT_FAILURE;
+    }
+    if (!ocupacion_final) {
+        // Sin resumen no se puede confirmar el estado final.
+        printf("[REPRODUCTOR] ⚠️ Traza incompleta: %s\n",
+                rapido ? "no se verificó nada" : "las respuestas coinciden, pero no se verificó el estado final");
+        return EXIT_FAILURE;
+    }
+    printf("[REPRODUCTOR] ✅ La reproducción coincide con la traza\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/**
+ *  @file reservas.c
+ *  @brief Lógica de decisión de reservas del controlador.
+ *
+ *  Contiene las reglas que deciden si una solicitud se acepta, se reprograma,
+ *  es extemporánea o se niega. Todo el estado (ocupación por día y hora y
+ *  contadores) vive en un EstadoReservas explícito, de modo que el controlador
+ *  y el reproductor de trazas comparten exactamente las mismas decisiones. Los
+ *  agentes usan reservas_prever sobre su copia de la vista compartida para no
+ *  enviar solicitudes que serían negadas.
+ *
+ *  La ocupación es un calendario deslizante de 'horizonte' días guardado como
+ *  un anillo de arreglos por día, así la memoria depende solo del horizonte y
+ *  no de cuántos días lleve corriendo la simulación.
+ *
+ *  Este módulo no hace E/S: solo actualiza el estado y llena la respuesta.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reservas.h"
+
+// Inicializar el estado con los parámetros de la simulación.
+int reservas_iniciar(EstadoReservas *e, int horaIni, int horaFin, int aforo, int horizonte) {
+    memset(e, 0, sizeof(*e));
+    e->horaIniSim = horaIni;
+    e->horaFinSim = horaFin;
+    e->aforoMax = aforo;
+    e->horizonte = horizonte;
+    e->horas_dia = horaFin - horaIni + 1;
+
+    e->slots = calloc((size_t)horizonte * e->horas_dia, sizeof(*e->slots));
+    return e->slots ? 0 : -1;
+}
+
+// Liberar la memoria del calendario.
+void reservas_liberar(EstadoReservas *e) {
+    free(e->slots);
+    e->slots = NULL;
+}
+
+// Copiar el estado completo entre dos calendarios de las mismas dimensiones.
+void reservas_copiar(EstadoReservas *dst, const EstadoReservas *src) {
+    unsigned short *slots = dst->slots;
+    *dst = *src;
+    dst->slots = slots;
+    memcpy(dst->slots, src->slots, (size_t)src->horizonte * src->horas_dia * sizeof(*src->slots));
+}
+
+// Avanzar el calendario un día: el primer día expira y se reutiliza como el último.
+void reservas_avanzar_dia(EstadoReservas *e) {
+    memset(&e->slots[(size_t)e->primero * e->horas_dia], 0, e->horas_dia * sizeof(*e->slots));
+    e->primero = (e->primero + 1) % e->horizonte;
+    e->dia_base++;
+}
+
+// Arreglo de ocupación de un día (índice h - horaIniSim), o NULL fuera del horizonte.
+unsigned short *reservas_dia(const EstadoReservas *e, int dia) {
+    int offset = dia - e->dia_base;
+    if (offset < 0 || offset >= e->horizonte) { return NULL; }
+
+    int idx = (e->primero + offset) % e->horizonte;
+    return &e->slots[(size_t)idx * e->horas_dia];
+}
+
+// Ocupación de una hora de un día (0 fuera del horizonte o del horario).
+int reservas_ocupacion(const EstadoReservas *e, int dia, int h) {
+    const unsigned short *s = reservas_dia(e, dia);
+    if (!s || h < e->horaIniSim || h > e->horaFinSim) { return 0; }
+    return s[h - e->horaIniSim];
+}
+
+// ¿Caben 'personas' en el bloque h, h+1 de un día?
+static int bloque_libre(const EstadoReservas *e, const unsigned short *s, int h, int personas) {
+    int i = h - e->horaIniSim;
+    return !(s[i] + personas > e->aforoMax || s[i+1] + personas > e->aforoMax);
+}
+
+// Verificar si se puede reservar en la hora dada.
+int puede_reservar_en_hora(const EstadoReservas *e, int dia, int h, int personas) {
+    if (h < e->horaIniSim) { return 0; }
+    if (h + 1 > e->horaFinSim) { return 0; }
+
+    const unsigned short *s = reservas_dia(e, dia);
+    if (!s) { return 0; }
+
+    return bloque_libre(e, s, h, personas);
+}
+
+// Buscar un bloque de 2 horas disponible desde ('dia', 'inicio') en adelante,
+// pasando a los días siguientes del horizonte. Deja en 'dia' el día encontrado.
+int buscar_bloque_dos_horas(const EstadoReservas *e, int personas, int *dia, int inicio) {
+    int d = *dia;
+    if (d < e->dia_base) {
+        d = e->dia_base;
+        inicio = e->horaIniSim;
+    }
+
+    for (; d < e->dia_base + e->horizonte; d++, inicio = e->horaIniSim) {
+        if (inicio < e->horaIniSim) { inicio = e->horaIniSim; }
+
+        const unsigned short *s = reservas_dia(e, d);
+        for (int h = inicio; h <= e->horaFinSim - 1; h++) {
+            if (bloque_libre(e, s, h, personas)) {
+                *dia = d;
+                return h;
+            }
+        }
+    }
+    return -1;
+}
+
+// Sumar personas al bloque de 2 horas de un día.
+static void ocupar_bloque(EstadoReservas *e, int dia, int h, int personas) {
+    unsigned short *s = reservas_dia(e, dia);
+    s[h - e->horaIniSim] += personas;
+    s[h - e->horaIniSim + 1] += personas;
+}
+
+// Escribir el texto de la respuesta como 'prefijo', el nombre de la familia y
+// el resto con formato. Si no cabe, se recorta el nombre de la familia para no
+// perder el resto (horas, día o razón).
+static void escribir_mensaje(RespuestaControlador *respuesta, const char *prefijo, const char *familia,
+                             const char *fmt, ...) {
+    char resto[sizeof(respuesta->mensaje)];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(resto, sizeof(resto), fmt, args);
+    va_end(args);
+
+    // La familia se queda con lo que no usan el prefijo y el resto.
+    int espacio = (int)sizeof(respuesta->mensaje) - 1 - (int)strlen(prefijo) - (int)strlen(resto);
+    if (espacio < 0) { espacio = 0; }
+
+    int n = snprintf(respuesta->mensaje, sizeof(respuesta->mensaje), "%s%.*s%s", prefijo, espacio, familia, resto);
+    if (n < 0) { respuesta->mensaje[0] = '\0'; }
+}
+
+// Procesar diferentes tipos de reservas.
+static void procesar_reserva_ok(EstadoReservas *e, const MensajeReserva *msg,
+                                RespuestaControlador *respuesta) {
+    ocupar_bloque(e, msg->dia_solicitado, msg->hora_solicitada, msg->num_personas);
+    e->solicitudes_ok++;
+
+    respuesta->tipo = RESERVA_OK;
+    respuesta->dia_asignado = msg->dia_solicitado;
+    respuesta->hora_asignada = msg->hora_solicitada;
+    escribir_mensaje(respuesta, "Reserva OK para ", msg->nombre_familia, " (%d personas) en %d-%d del día %d",
+                msg->num_personas,
+                msg->hora_solicitada,
+                msg->hora_solicitada+2,
+                msg->dia_solicitado);
+}
+
+// Procesar reserva reprogramada a otras horas.
+static void procesar_reserva_otras_horas(EstadoReservas *e, const MensajeReserva *msg, int nuevoD,
+                                         int nuevaH, RespuestaControlador *respuesta) {
+    ocupar_bloque(e, nuevoD, nuevaH, msg->num_personas);
+    e->solicitudes_reprogramadas++;
+
+    respuesta->tipo = RESERVA_OTRAS_HORAS;
+    respuesta->dia_asignado = nuevoD;
+    respuesta->hora_asignada = nuevaH;
+    snprintf(respuesta->mensaje, sizeof(respuesta->mensaje), "Sin cupo en %d del día %d. Reprogramada a %d-%d del día %d",
+                msg->hora_solicitada, msg->dia_solicitado, nuevaH, nuevaH+2, nuevoD);
+}
+
+// Procesar reserva extemporánea.
+static void procesar_reserva_extemporanea(EstadoReservas *e, const MensajeReserva *msg, int nuevoD,
+                                          int nuevaH, RespuestaControlador *respuesta) {
+    ocupar_bloque(e, nuevoD, nuevaH, msg->num_personas);
+    e->solicitudes_extemporaneas++;
+
+    respuesta->tipo = RESERVA_EXTEMPORANEA;
+    respuesta->dia_asignado = nuevoD;
+    respuesta->hora_asignada = nuevaH;
+    snprintf(respuesta->mensaje, sizeof(respuesta->mensaje), "Hora solicitada ya pasó. Reprogramada a %d-%d del día %d",
+                nuevaH, nuevaH+2, nuevoD);
+}
+
+// Procesar reserva negada.
+static void procesar_reserva_negada(EstadoReservas *e, const MensajeReserva *msg, const char *razon,
+                                    RespuestaControlador *respuesta) {
+    e->solicitudes_negadas++;
+
+    respuesta->tipo = RESERVA_NEGADA;
+    respuesta->dia_asignado = -1;
+    respuesta->hora_asignada = -1;
+    escribir_mensaje(respuesta, "Reserva negada para ", msg->nombre_familia, ": %s", razon);
+}
+
+// Prever el resultado de una solicitud sin modificar el estado. Deja en 'dia'
+// y 'hora' el bloque que se asignaría y, si se negaría, la razón en 'razon'.
+TipoRespuesta reservas_prever(const EstadoReservas *e, const MensajeReserva *msg, int dia_actual, int hora_actual,
+                              int *dia, int *hora, const char **razon) {
+    *dia = msg->dia_solicitado;
+    *hora = msg->hora_solicitada;
+    *razon = NULL;
+
+    // Validaciones.
+    if (msg->num_personas <= 0) {
+        *razon = "Número de personas inválido";
+        return RESERVA_NEGADA;
+    }
+
+    if (msg->num_personas > e->aforoMax) {
+        *razon = "Grupo supera aforo máximo";
+        return RESERVA_NEGADA;
+    }
+
+    if (msg->hora_solicitada > e->horaFinSim) {
+        *razon = "Hora solicitada fuera del rango";
+        return RESERVA_NEGADA;
+    }
+
+    if (msg->dia_solicitado >= e->dia_base + e->horizonte) {
+        *razon = "Fecha fuera del horizonte";
+        return RESERVA_NEGADA;
+    }
+
+    if (msg->dia_solicitado < dia_actual ||
+        (msg->dia_solicitado == dia_actual && msg->hora_solicitada < hora_actual)) {
+        *dia = dia_actual;
+        *hora = buscar_bloque_dos_horas(e, msg->num_personas, dia, hora_actual);
+        if (*hora == -1) {
+            *razon = "Extemporánea y sin cupo";
+            return RESERVA_NEGADA;
+        }
+        return RESERVA_EXTEMPORANEA;
+    }
+
+    if (puede_reservar_en_hora(e, msg->dia_solicitado, msg->hora_solicitada, msg->num_personas)) {
+        return RESERVA_OK;
+    }
+
+    // Buscar desde el día pedido (desde la hora actual si es hoy) hacia adelante.
+    *hora = buscar_bloque_dos_horas(e, msg->num_personas, dia,
+                                    *dia == dia_actual ? hora_actual : e->horaIniSim);
+    if (*hora == -1) {
+        *razon = "Sin bloques disponibles";
+        return RESERVA_NEGADA;
+    }
+    return RESERVA_OTRAS_HORAS;
+}
+
+// Decidir una solicitud de reserva dado el día y la hora simulada actuales.
+void reservas_decidir(EstadoReservas *e, const MensajeReserva *msg, int dia_actual, int hora_actual,
+                      RespuestaControlador *resp) {
+    int nd, nh;
+    const char *razon;
+
+    switch (reservas_prever(e, msg, dia_actual, hora_actual, &nd, &nh, &razon)) {
+    case RESERVA_OK:
+        procesar_reserva_ok(e, msg, resp);
+        break;
+    case RESERVA_OTRAS_HORAS:
+        procesar_reserva_otras_horas(e, msg, nd, nh, resp);
+        break;
+    case RESERVA_EXTEMPORANEA:
+        procesar_reserva_extemporanea(e, msg, nd, nh, resp);
+        break;
+    default:
+        procesar_reserva_negada(e, msg, razon, resp);
+        break;
+    }
+}
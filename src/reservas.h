@@ -0,0 +1,48 @@
+#ifndef RESERVAS_H
+#define RESERVAS_H
+
+#include "../include/estructuras.h"
+
+// Constantes.
+#define MAX_AFORO 65535
+
+// Estado de ocupación y contadores que usa la lógica de decisión.
+//
+// La ocupación cubre 'horizonte' días a partir de 'dia_base'. Cada día es un
+// arreglo de 'horas_dia' contadores (horaIniSim..horaFinSim) y los días forman
+// un anillo: al avanzar un día, el arreglo del día que expira se limpia y se
+// reutiliza para el nuevo último día del horizonte.
+typedef struct {
+    int horaIniSim;
+    int horaFinSim;
+    int aforoMax;
+
+    int horizonte;
+    int horas_dia;
+    int dia_base;
+    int primero;
+    unsigned short *slots;
+
+    int solicitudes_ok;
+    int solicitudes_extemporaneas;
+    int solicitudes_reprogramadas;
+    int solicitudes_negadas;
+} EstadoReservas;
+
+// Funciones de estado.
+int reservas_iniciar(EstadoReservas *e, int horaIni, int horaFin, int aforo, int horizonte);
+void reservas_liberar(EstadoReservas *e);
+void reservas_copiar(EstadoReservas *dst, const EstadoReservas *src);
+void reservas_avanzar_dia(EstadoReservas *e);
+unsigned short *reservas_dia(const EstadoReservas *e, int dia);
+int reservas_ocupacion(const EstadoReservas *e, int dia, int h);
+
+// Funciones de decisión.
+int puede_reservar_en_hora(const EstadoReservas *e, int dia, int h, int personas);
+int buscar_bloque_dos_horas(const EstadoReservas *e, int personas, int *dia, int inicio);
+TipoRespuesta reservas_prever(const EstadoReservas *e, const MensajeReserva *msg, int dia_actual, int hora_actual,
+                              int *dia, int *hora, const char **razon);
+void reservas_decidir(EstadoReservas *e, const MensajeReserva *msg, int dia_actual, int hora_actual,
+                      RespuestaControlador *resp);
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ *  @file traza.c
+ *  @brief Grabación y lectura de trazas binarias del controlador.
+ *
+ *  Una traza guarda cada mensaje recibido por el controlador junto con el día y
+ *  la hora simulados y el resultado de la decisión. Los registros van en el
+ *  orden en que se decidieron, que es el que hay que repetir para reproducir el
+ *  estado; como el planificador reordena las colas por agente, ese orden puede
+ *  diferir del de llegada, que queda en t_ns (no necesariamente creciente).
+ *  Al final se escribe un resumen con la ocupación de todo el horizonte y los
+ *  contadores, de modo que el reproductor pueda verificar que la lógica sigue
+ *  decidiendo lo mismo.
+ *
+ *  El formato usa registros de tamaño fijo en el orden de bytes de la máquina
+ *  (el tamaño del registro se guarda en la cabecera para detectar cambios).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "traza.h"
+
+// Tiempo monotónico en nanosegundos.
+static uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Abrir la traza y escribir la cabecera.
+int traza_abrir(Traza *t, const char *ruta, const EstadoReservas *e) {
+    t->archivo = fopen(ruta, "wb");
+    if (!t->archivo) {
+        perror("Error abriendo traza");
+        return -1;
+    }
+
+    CabeceraTraza cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magia, TRAZA_MAGIA, sizeof(cab.magia));
+    cab.version = TRAZA_VERSION;
+    cab.tam_registro = sizeof(RegistroTraza);
+    cab.horaIniSim = e->horaIniSim;
+    cab.horaFinSim = e->horaFinSim;
+    cab.aforoMax = e->aforoMax;
+    cab.horizonte = e->horizonte;
+
+    if (fwrite(&cab, sizeof(cab), 1, t->archivo) != 1 || fflush(t->archivo) != 0) {
+        perror("Error escribiendo cabecera de traza");
+        fclose(t->archivo);
+        t->archivo = NULL;
+        return -1;
+    }
+
+    t->t0_ns = ahora_ns();
+    return 0;
+}
+
+// Escribir un registro y vaciarlo al archivo, para que un controlador que
+// termina mal no pierda los últimos mensajes.
+static void escribir_registro(Traza *t, const RegistroTraza *reg) {
+    if (fwrite(reg, sizeof(*reg), 1, t->archivo) != 1 || fflush(t->archivo) != 0) {
+        perror("Error escribiendo traza");
+    }
+}
+
+// Instante actual en ns desde que se abrió la traza (0 si no se graba).
+uint64_t traza_marca(const Traza *t) {
+    if (!t->archivo) { return 0; }
+
+    return ahora_ns() - t->t0_ns;
+}
+
+// Registrar un saludo HELLO (se atiende apenas llega).
+void traza_registrar_hola(Traza *t, const MensajeHola *hola, int dia_actual, int hora_actual) {
+    if (!t->archivo) { return; }
+
+    RegistroTraza reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.t_ns = traza_marca(t);
+    reg.tipo = MSG_HOLA;
+    reg.dia_actual = dia_actual;
+    reg.hora_actual = hora_actual;
+    reg.resultado = -1;
+    reg.dia_asignado = dia_actual;
+    reg.hora_asignada = hora_actual;
+    strncpy(reg.nombre_agente, hola->nombre_agente, MAX_NOMBRE - 1);
+
+    escribir_registro(t, &reg);
+}
+
+// Registrar una reserva y la respuesta que se le dio.
+void traza_registrar_reserva(Traza *t, const MensajeReserva *msg, uint64_t llegada_ns,
+                             int dia_actual, int hora_actual, const RespuestaControlador *resp) {
+    if (!t->archivo) { return; }
+
+    RegistroTraza reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.t_ns = llegada_ns;
+    reg.tipo = MSG_RESERVA;
+    reg.dia_actual = dia_actual;
+    reg.hora_actual = hora_actual;
+    reg.dia_solicitado = msg->dia_solicitado;
+    reg.hora_solicitada = msg->hora_solicitada;
+    reg.num_personas = msg->num_personas;
+    reg.resultado = resp->tipo;
+    reg.dia_asignado = resp->dia_asignado;
+    reg.hora_asignada = resp->hora_asignada;
+    strncpy(reg.nombre_agente, msg->nombre_agente, MAX_NOMBRE - 1);
+    strncpy(reg.nombre_familia, msg->nombre_familia, MAX_NOMBRE - 1);
+
+    escribir_registro(t, &reg);
+}
+
+// Escribir el registro de cierre con el estado final y cerrar el archivo.
+void traza_cerrar(Traza *t, const EstadoReservas *e) {
+    if (!t->archivo) { return; }
+
+    RegistroTraza reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.t_ns = traza_marca(t);
+    reg.tipo = TRAZA_CIERRE;
+    fwrite(&reg, sizeof(reg), 1, t->archivo);
+
+    ResumenTraza res;
+    memset(&res, 0, sizeof(res));
+    res.solicitudes_ok = e->solicitudes_ok;
+    res.solicitudes_extemporaneas = e->solicitudes_extemporaneas;
+    res.solicitudes_reprogramadas = e->solicitudes_reprogramadas;
+    res.solicitudes_negadas = e->solicitudes_negadas;
+    res.dia_base = e->dia_base;
+    res.horizonte = e->horizonte;
+    res.horas_dia = e->horas_dia;
+    fwrite(&res, sizeof(res), 1, t->archivo);
+
+    // Ocupación en orden de días, sin importar la posición en el anillo.
+    for (int d = e->dia_base; d < e->dia_base + e->horizonte; d++) {
+        fwrite(reservas_dia(e, d), sizeof(*e->slots), e->horas_dia, t->archivo);
+    }
+
+    fclose(t->archivo);
+    t->archivo = NULL;
+}
+
+// Leer y validar la cabecera de una traza.
+int traza_leer_cabecera(FILE *f, CabeceraTraza *cab) {
+    if (fread(cab, sizeof(*cab), 1, f) != 1) {
+        return -1;
+    }
+    if (memcmp(cab->magia, TRAZA_MAGIA, sizeof(cab->magia)) != 0 ||
+        cab->version != TRAZA_VERSION ||
+        cab->tam_registro != sizeof(RegistroTraza)) {
+        return -1;
+    }
+    return 0;
+}
+
+// Leer el siguiente registro. Devuelve 0 si hay registro, -1 al final del archivo.
+int traza_leer_registro(FILE *f, RegistroTraza *reg) {
+    return fread(reg, sizeof(*reg), 1, f) == 1 ? 0 : -1;
+}
+
+// Leer el resumen que sigue al registro de cierre. Devuelve la ocupación
+// (a liberar con free) o NULL si el resumen está incompleto.
+unsigned short *traza_leer_resumen(FILE *f, ResumenTraza *res) {
+    if (fread(res, sizeof(*res), 1, f) != 1 || res->horizonte <= 0 || res->horas_dia <= 0) {
+        return NULL;
+    }
+
+    size_t total = (size_t)res->horizonte * res->horas_dia;
+    unsigned short *ocupacion = malloc(total * sizeof(*ocupacion));
+    if (ocupacion && fread(ocupacion, sizeof(*ocupacion), total, f) != total) {
+        free(ocupacion);
+        ocupacion = NULL;
+    }
+    return ocupacion;
+}
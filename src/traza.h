@@ -0,0 +1,72 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "reservas.h"
+
+#define TRAZA_MAGIA "RSVTRAZA"
+#define TRAZA_VERSION 2
+
+// Marca de tipo que cierra la traza; la sigue un ResumenTraza.
+#define TRAZA_CIERRE (-1)
+
+// Cabecera del archivo: parámetros con los que corrió el controlador.
+typedef struct {
+    char magia[8];
+    uint32_t version;
+    uint32_t tam_registro;
+    int32_t horaIniSim;
+    int32_t horaFinSim;
+    int32_t aforoMax;
+    int32_t horizonte;
+} CabeceraTraza;
+
+// Un mensaje recibido por el controlador y el resultado que obtuvo.
+typedef struct {
+    uint64_t t_ns;              // Llegada al pipe principal, en ns desde que se abrió la traza.
+    int32_t tipo;               // TipoMensaje o TRAZA_CIERRE.
+    int32_t dia_actual;         // Día y hora simulados al momento de decidir.
+    int32_t hora_actual;
+    int32_t dia_solicitado;
+    int32_t hora_solicitada;
+    int32_t num_personas;
+    int32_t resultado;          // TipoRespuesta; -1 para HELLO.
+    int32_t dia_asignado;
+    int32_t hora_asignada;
+    char nombre_agente[MAX_NOMBRE];
+    char nombre_familia[MAX_NOMBRE];
+} RegistroTraza;
+
+// Estado final registrado al cerrar la traza. Lo siguen horizonte * horas_dia
+// contadores de ocupación (uint16), día por día desde dia_base.
+typedef struct {
+    int32_t solicitudes_ok;
+    int32_t solicitudes_extemporaneas;
+    int32_t solicitudes_reprogramadas;
+    int32_t solicitudes_negadas;
+    int32_t dia_base;
+    int32_t horizonte;
+    int32_t horas_dia;
+} ResumenTraza;
+
+// Traza abierta para escritura.
+typedef struct {
+    FILE *archivo;
+    uint64_t t0_ns;
+} Traza;
+
+// Funciones de escritura (controlador).
+int traza_abrir(Traza *t, const char *ruta, const EstadoReservas *e);
+uint64_t traza_marca(const Traza *t);
+void traza_registrar_hola(Traza *t, const MensajeHola *hola, int dia_actual, int hora_actual);
+void traza_registrar_reserva(Traza *t, const MensajeReserva *msg, uint64_t llegada_ns,
+                             int dia_actual, int hora_actual, const RespuestaControlador *resp);
+void traza_cerrar(Traza *t, const EstadoReservas *e);
+
+// Funciones de lectura (reproductor).
+int traza_leer_cabecera(FILE *f, CabeceraTraza *cab);
+int traza_leer_registro(FILE *f, RegistroTraza *reg);
+unsigned short *traza_leer_resumen(FILE *f, ResumenTraza *res);
+
+#endif
@@ -0,0 +1,201 @@
+/**
+ *  @file vista.c
+ *  @brief Vista compartida de la ocupación para los agentes.
+ *
+ *  El controlador publica su calendario de ocupación en un segmento de memoria
+ *  compartida POSIX y los agentes lo mapean solo lectura. Así un agente puede
+ *  descartar antes de enviarla una solicitud que con seguridad será negada,
+ *  sin ida y vuelta por los pipes ni tiempo del controlador.
+ *
+ *  La consistencia se logra con un contador de secuencia (seqlock): el
+ *  controlador lo deja impar mientras copia el calendario y par al terminar, y
+ *  el agente repite la lectura si el contador cambió o era impar.
+ *
+ *  Como la ocupación de un día solo crece, una vista algo atrasada solo puede
+ *  ser optimista: nunca muestra lleno algo que no lo está.
+ *
+ *  El segmento tiene nombre y sobrevive al proceso: el controlador lo borra al
+ *  terminar normalmente o por SIGINT/SIGTERM, y al iniciar borra los que hayan
+ *  dejado controladores muertos (por ejemplo, con SIGKILL).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "vista.h"
+
+// Tamaño del segmento para un calendario dado.
+static size_t tam_vista(int horizonte, int horas_dia) {
+    return sizeof(VistaOcupacion) + (size_t)horizonte * horas_dia * sizeof(unsigned short);
+}
+
+// Crear el segmento compartido y publicar el estado inicial.
+VistaOcupacion *vista_crear(const char *nombre, const EstadoReservas *e) {
+    shm_unlink(nombre);
+
+    int fd = shm_open(nombre, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) {
+        perror("Error creando vista de ocupación");
+        return NULL;
+    }
+
+    size_t tam = tam_vista(e->horizonte, e->horas_dia);
+    if (ftruncate(fd, tam) == -1) {
+        perror("Error dimensionando vista de ocupación");
+        close(fd);
+        shm_unlink(nombre);
+        return NULL;
+    }
+
+    VistaOcupacion *v = mmap(NULL, tam, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (v == MAP_FAILED) {
+        perror("Error mapeando vista de ocupación");
+        shm_unlink(nombre);
+        return NULL;
+    }
+
+    // Campos fijos: no cambian durante la simulación.
+    v->horaIniSim = e->horaIniSim;
+    v->horaFinSim = e->horaFinSim;
+    v->aforoMax = e->aforoMax;
+    v->horizonte = e->horizonte;
+    v->horas_dia = e->horas_dia;
+
+    vista_publicar(v, e, e->dia_base, e->horaIniSim);
+    return v;
+}
+
+// Copiar el calendario actual a la vista compartida.
+void vista_publicar(VistaOcupacion *v, const EstadoReservas *e, int dia_actual, int hora_actual) {
+    if (!v) { return; }
+
+    unsigned int s = v->secuencia;
+    __atomic_store_n(&v->secuencia, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    v->dia_base = e->dia_base;
+    v->primero = e->primero;
+    v->dia_actual = dia_actual;
+    v->hora_actual = hora_actual;
+    memcpy(v->slots, e->slots, (size_t)e->horizonte * e->horas_dia * sizeof(*e->slots));
+
+    __atomic_store_n(&v->secuencia, s + 2, __ATOMIC_RELEASE);
+}
+
+// Copiar a la vista solo la ocupación de un día, tras una decisión que lo
+// cambió. El resto del calendario, el día y la hora no cambian.
+void vista_publicar_dia(VistaOcupacion *v, const EstadoReservas *e, int dia) {
+    const unsigned short *s = reservas_dia(e, dia);
+    if (!v || !s) { return; }
+
+    unsigned int sec = v->secuencia;
+    __atomic_store_n(&v->secuencia, sec + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    // Misma posición en el anillo que en el estado.
+    memcpy(v->slots + (s - e->slots), s, (size_t)e->horas_dia * sizeof(*s));
+
+    __atomic_store_n(&v->secuencia, sec + 2, __ATOMIC_RELEASE);
+}
+
+// Desmapear y eliminar el segmento.
+void vista_destruir(VistaOcupacion *v, const char *nombre) {
+    if (!v) { return; }
+
+    munmap(v, tam_vista(v->horizonte, v->horas_dia));
+    shm_unlink(nombre);
+}
+
+// Quitar el nombre del segmento. Se puede llamar desde un manejador de señales.
+void vista_desvincular(const char *nombre) {
+    shm_unlink(nombre);
+}
+
+// Borrar las vistas de controladores que ya no existen. En Linux los segmentos
+// están en /dev/shm; si no existe, no hay nada que limpiar.
+void vista_limpiar_huerfanas(void) {
+    DIR *dir = opendir("/dev/shm");
+    if (!dir) { return; }
+
+    const char *prefijo = VISTA_PREFIJO + 1;
+    size_t largo = strlen(prefijo);
+    struct dirent *ent;
+
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, prefijo, largo) != 0) { continue; }
+
+        char *fin;
+        long pid = strtol(ent->d_name + largo, &fin, 10);
+        if (*fin != '\0' || pid <= 0) { continue; }
+
+        if (kill((pid_t)pid, 0) == -1 && errno == ESRCH) {
+            char nombre[300];
+            snprintf(nombre, sizeof(nombre), "/%s", ent->d_name);
+            shm_unlink(nombre);
+        }
+    }
+    closedir(dir);
+}
+
+// Mapear solo lectura la vista publicada por el controlador.
+const VistaOcupacion *vista_abrir(const char *nombre) {
+    int fd = shm_open(nombre, O_RDONLY, 0);
+    if (fd == -1) {
+        perror("Error abriendo vista de ocupación");
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(VistaOcupacion)) {
+        close(fd);
+        return NULL;
+    }
+
+    const VistaOcupacion *v = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (v == MAP_FAILED) {
+        perror("Error mapeando vista de ocupación");
+        return NULL;
+    }
+
+    if ((size_t)st.st_size != tam_vista(v->horizonte, v->horas_dia)) {
+        munmap((void *)v, st.st_size);
+        return NULL;
+    }
+    return v;
+}
+
+// Copiar una instantánea consistente de la vista a un estado local.
+// 'e' debe haberse creado con reservas_iniciar y las dimensiones de la vista.
+void vista_leer(const VistaOcupacion *v, EstadoReservas *e, int *dia_actual, int *hora_actual) {
+    unsigned int s1, s2;
+
+    do {
+        s1 = __atomic_load_n(&v->secuencia, __ATOMIC_ACQUIRE);
+        if (s1 & 1) { continue; }
+
+        e->dia_base = v->dia_base;
+        e->primero = v->primero;
+        *dia_actual = v->dia_actual;
+        *hora_actual = v->hora_actual;
+        memcpy(e->slots, v->slots, (size_t)e->horizonte * e->horas_dia * sizeof(*e->slots));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&v->secuencia, __ATOMIC_RELAXED);
+    } while ((s1 & 1) || s1 != s2);
+}
+
+// Desmapear la vista.
+void vista_cerrar(const VistaOcupacion *v) {
+    if (!v) { return; }
+
+    munmap((void *)v, tam_vista(v->horizonte, v->horas_dia));
+}
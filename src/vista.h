@@ -0,0 +1,38 @@
+#ifndef VISTA_H
+#define VISTA_H
+
+#include "reservas.h"
+
+// Nombre de la vista: prefijo seguido del pid del controlador.
+#define VISTA_PREFIJO "/reservas_vista_"
+
+// Ocupación publicada en memoria compartida. Los agentes la mapean solo
+// lectura. 'secuencia' es impar mientras el controlador la está escribiendo.
+typedef struct {
+    unsigned int secuencia;
+    int horaIniSim;
+    int horaFinSim;
+    int aforoMax;
+    int horizonte;
+    int horas_dia;
+    int dia_base;
+    int primero;
+    int dia_actual;
+    int hora_actual;
+    unsigned short slots[];
+} VistaOcupacion;
+
+// Funciones del controlador (escritura).
+VistaOcupacion *vista_crear(const char *nombre, const EstadoReservas *e);
+void vista_publicar(VistaOcupacion *v, const EstadoReservas *e, int dia_actual, int hora_actual);
+void vista_publicar_dia(VistaOcupacion *v, const EstadoReservas *e, int dia);
+void vista_destruir(VistaOcupacion *v, const char *nombre);
+void vista_desvincular(const char *nombre);
+void vista_limpiar_huerfanas(void);
+
+// Funciones del agente (lectura).
+const VistaOcupacion *vista_abrir(const char *nombre);
+void vista_leer(const VistaOcupacion *v, EstadoReservas *e, int *dia_actual, int *hora_actual);
+void vista_cerrar(const VistaOcupacion *v);
+
+#endif